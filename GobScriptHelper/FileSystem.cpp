@@ -0,0 +1,544 @@
+#include "FileSystem.hpp"
+#include "../Pigeon/Process.hpp"
+#include "Parallel.hpp"
+#include <fstream>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <mutex>
+#include <algorithm>
+#include <cstring>
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <dirent.h>
+#include <errno.h>
+#if defined(__linux__)
+#include <linux/fs.h>
+#endif
+#endif
+
+namespace GobScriptHelper::FileSystem
+{
+    /// @brief Errors of file operations that have no matching errno value
+    enum class Error
+    {
+        /// @brief Copying a file onto itself, which would otherwise leave it empty
+        SameFile = 1,
+        /// @brief Copying a directory inside of itself, which would otherwise never end
+        CopyIntoItself,
+    };
+
+    class ErrorCategory : public std::error_category
+    {
+    public:
+        char const *name() const noexcept override { return "file system"; }
+
+        std::string message(int error) const override
+        {
+            switch ((Error)error)
+            {
+            case Error::SameFile:
+                return "Source and target are the same file";
+            case Error::CopyIntoItself:
+                return "Can't copy a directory into itself";
+            }
+            return "Unknown error";
+        }
+    };
+
+    static std::error_code makeError(Error error)
+    {
+        static ErrorCategory category;
+        return std::error_code((int)error, category);
+    }
+
+    /// @brief Get path that should be used as the target of copy or move, which is inside of the target if target is an existing directory
+    static std::filesystem::path getTargetPath(std::filesystem::path const &from, std::filesystem::path const &to)
+    {
+        std::error_code ignored;
+        if (std::filesystem::is_directory(to, ignored))
+        {
+            return to / from.filename();
+        }
+        return to;
+    }
+
+    std::error_code makeDirectory(std::filesystem::path const &path)
+    {
+        std::error_code error;
+        std::filesystem::create_directories(path, error);
+        return error;
+    }
+
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+    std::error_code copyFile(std::filesystem::path const &from, std::filesystem::path const &to)
+    {
+        int input = open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (input == -1)
+        {
+            return std::error_code(errno, std::generic_category());
+        }
+        struct stat info;
+        if (fstat(input, &info) == -1)
+        {
+            std::error_code error(errno, std::generic_category());
+            close(input);
+            return error;
+        }
+        // target is truncated only after checking that it isn't the source, which would destroy the data we are about to copy
+        int output = open(to.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, info.st_mode & 07777);
+        if (output == -1)
+        {
+            std::error_code error(errno, std::generic_category());
+            close(input);
+            return error;
+        }
+        struct stat targetInfo;
+        std::error_code error;
+        if (fstat(output, &targetInfo) == -1)
+        {
+            error = std::error_code(errno, std::generic_category());
+        }
+        else if (targetInfo.st_dev == info.st_dev && targetInfo.st_ino == info.st_ino)
+        {
+            error = makeError(Error::SameFile);
+        }
+        else if (ftruncate(output, 0) == -1)
+        {
+            error = std::error_code(errno, std::generic_category());
+        }
+        if (error)
+        {
+            close(input);
+            close(output);
+            return error;
+        }
+#if defined(FICLONE)
+        // on file systems like btrfs or xfs the copy can share data with the original until one of them is changed, which takes no time regardless of the size
+        if (ioctl(output, FICLONE, input) == 0)
+        {
+            close(input);
+            close(output);
+            return error;
+        }
+#endif
+        bool kernelCopy = true;
+        while (kernelCopy)
+        {
+            ssize_t copied = copy_file_range(input, nullptr, output, nullptr, 1 << 30, 0);
+            if (copied == 0)
+            {
+                break;
+            }
+            if (copied == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                // older kernels and some file systems can't copy between these files, offsets are still valid so we continue manually
+                if (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)
+                {
+                    kernelCopy = false;
+                    break;
+                }
+                error = std::error_code(errno, std::generic_category());
+                break;
+            }
+        }
+        if (!kernelCopy)
+        {
+            std::vector<char> buffer(1 << 16);
+            while (true)
+            {
+                ssize_t count = read(input, buffer.data(), buffer.size());
+                if (count == 0)
+                {
+                    break;
+                }
+                if (count == -1)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    error = std::error_code(errno, std::generic_category());
+                    break;
+                }
+                for (ssize_t written = 0; written < count;)
+                {
+                    ssize_t result = write(output, buffer.data() + written, count - written);
+                    if (result == -1 && errno != EINTR)
+                    {
+                        error = std::error_code(errno, std::generic_category());
+                        break;
+                    }
+                    written += result == -1 ? 0 : result;
+                }
+                if (error)
+                {
+                    break;
+                }
+            }
+        }
+        close(input);
+        if (close(output) == -1 && !error)
+        {
+            error = std::error_code(errno, std::generic_category());
+        }
+        return error;
+    }
+
+    std::error_code touchFile(std::filesystem::path const &path)
+    {
+        // null sets both access and modification time to now, which only needs write permission for the directory entry, so read only files and directories work too
+        if (utimensat(AT_FDCWD, path.c_str(), nullptr, 0) == 0)
+        {
+            return {};
+        }
+        if (errno != ENOENT)
+        {
+            return std::error_code(errno, std::generic_category());
+        }
+        int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0666);
+        if (fd == -1)
+        {
+            return std::error_code(errno, std::generic_category());
+        }
+        close(fd);
+        return {};
+    }
+
+    std::error_code printFile(std::filesystem::path const &path)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            return std::error_code(errno, std::generic_category());
+        }
+        std::cout.flush();
+        Pigeon::Process::forwardOutput(fd, STDOUT_FILENO);
+        close(fd);
+        return {};
+    }
+
+    /// @brief Layout of records returned by getdents64, glibc doesn't provide it
+    struct LinuxDirent64
+    {
+        uint64_t d_ino;
+        int64_t d_off;
+        unsigned short d_reclen;
+        unsigned char d_type;
+        char d_name[];
+    };
+
+    static EntryType convertDirentType(unsigned char type)
+    {
+        switch (type)
+        {
+        case DT_REG:
+            return EntryType::File;
+        case DT_DIR:
+            return EntryType::Directory;
+        case DT_LNK:
+            return EntryType::Symlink;
+        default:
+            return EntryType::Other;
+        }
+    }
+
+    bool readDirectory(std::string const &path, std::function<void(char const *name, EntryType type)> const &callback)
+    {
+        int fd = open(path.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd == -1)
+        {
+            return false;
+        }
+        alignas(LinuxDirent64) char buffer[1 << 16];
+        while (true)
+        {
+            long count = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+            if (count <= 0)
+            {
+                break;
+            }
+            for (long offset = 0; offset < count;)
+            {
+                LinuxDirent64 const *entry = reinterpret_cast<LinuxDirent64 const *>(buffer + offset);
+                offset += entry->d_reclen;
+                if (strcmp(entry->d_name, ".") == 0 || strcmp(entry->d_name, "..") == 0)
+                {
+                    continue;
+                }
+                unsigned char direntType = entry->d_type;
+                // some file systems don't store the type in the directory, only then we have to ask for it
+                if (direntType == DT_UNKNOWN)
+                {
+                    struct stat info;
+                    if (fstatat(fd, entry->d_name, &info, AT_SYMLINK_NOFOLLOW) == 0)
+                    {
+                        direntType = IFTODT(info.st_mode);
+                    }
+                }
+                callback(entry->d_name, convertDirentType(direntType));
+            }
+        }
+        close(fd);
+        return true;
+    }
+
+    std::optional<EntryType> getEntryType(std::string const &path)
+    {
+        struct stat info;
+        if (lstat(path.c_str(), &info) != 0)
+        {
+            return {};
+        }
+        return convertDirentType(IFTODT(info.st_mode));
+    }
+
+    /// @brief Shared state of a single directory walk
+    struct DirectoryWalk
+    {
+        Parallel::WorkStealingPool &pool;
+        int64_t maxDepth;
+        uint8_t types;
+        std::mutex resultMutex;
+        std::vector<DirectoryEntry> result;
+    };
+
+    /// @brief Read one directory, submitting a new task for each subdirectory
+    static void walkSingleDirectory(DirectoryWalk &walk, std::string const &path, int64_t depth)
+    {
+        std::vector<DirectoryEntry> found;
+        readDirectory(path, [&](char const *name, EntryType type)
+                      {
+                          std::string entryPath = path.back() == '/' ? path + name : path + "/" + name;
+                          if (type == EntryType::Directory && (walk.maxDepth < 0 || depth < walk.maxDepth))
+                          {
+                              walk.pool.submit([&walk, entryPath, depth]()
+                                               { walkSingleDirectory(walk, entryPath, depth + 1); });
+                          }
+                          if (walk.types & type)
+                          {
+                              found.push_back(DirectoryEntry{.path = std::move(entryPath), .type = type});
+                          }
+                      });
+        if (!found.empty())
+        {
+            std::lock_guard<std::mutex> lock(walk.resultMutex);
+            walk.result.insert(walk.result.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+        }
+    }
+
+    std::vector<DirectoryEntry> walkDirectory(std::filesystem::path const &root, int64_t maxDepth, uint8_t types, size_t maxThreads)
+    {
+        Parallel::WorkStealingPool pool(maxThreads);
+        DirectoryWalk walk{.pool = pool, .maxDepth = maxDepth, .types = types};
+        if (maxDepth != 0)
+        {
+            pool.submit([&walk, path = root.string()]()
+                        { walkSingleDirectory(walk, path, 1); });
+            pool.waitIdle();
+        }
+        std::sort(walk.result.begin(), walk.result.end(), [](DirectoryEntry const &a, DirectoryEntry const &b)
+                  { return a.path < b.path; });
+        return std::move(walk.result);
+    }
+#else
+    std::error_code copyFile(std::filesystem::path const &from, std::filesystem::path const &to)
+    {
+        std::error_code error;
+        if (std::filesystem::equivalent(from, to, error))
+        {
+            return makeError(Error::SameFile);
+        }
+        std::filesystem::copy_file(from, to, std::filesystem::copy_options::overwrite_existing, error);
+        return error;
+    }
+
+    std::error_code touchFile(std::filesystem::path const &path)
+    {
+        std::error_code error;
+        if (!std::filesystem::exists(path, error))
+        {
+            std::ofstream file(path);
+            if (!file)
+            {
+                return std::make_error_code(std::errc::permission_denied);
+            }
+            return {};
+        }
+        std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), error);
+        return error;
+    }
+
+    std::error_code printFile(std::filesystem::path const &path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file)
+        {
+            return std::make_error_code(std::errc::no_such_file_or_directory);
+        }
+        std::cout << file.rdbuf();
+        return {};
+    }
+
+    /// @brief Get type of the entry from its status
+    static EntryType convertFileStatus(std::filesystem::file_status const &status)
+    {
+        return std::filesystem::is_symlink(status)        ? EntryType::Symlink
+               : std::filesystem::is_directory(status)    ? EntryType::Directory
+               : std::filesystem::is_regular_file(status) ? EntryType::File
+                                                          : EntryType::Other;
+    }
+
+    bool readDirectory(std::string const &path, std::function<void(char const *name, EntryType type)> const &callback)
+    {
+        std::error_code error;
+        std::filesystem::directory_iterator it(path, error);
+        if (error)
+        {
+            return false;
+        }
+        for (std::filesystem::directory_iterator end; !error && it != end; it.increment(error))
+        {
+            callback(it->path().filename().string().c_str(), convertFileStatus(it->symlink_status(error)));
+        }
+        return true;
+    }
+
+    std::optional<EntryType> getEntryType(std::string const &path)
+    {
+        std::error_code error;
+        std::filesystem::file_status status = std::filesystem::symlink_status(path, error);
+        if (error || !std::filesystem::exists(status))
+        {
+            return {};
+        }
+        return convertFileStatus(status);
+    }
+
+    std::vector<DirectoryEntry> walkDirectory(std::filesystem::path const &root, int64_t maxDepth, uint8_t types, size_t maxThreads)
+    {
+        std::vector<DirectoryEntry> result;
+        if (maxDepth == 0)
+        {
+            return result;
+        }
+        std::error_code error;
+        for (std::filesystem::recursive_directory_iterator it(root, std::filesystem::directory_options::skip_permission_denied, error), end; !error && it != end; it.increment(error))
+        {
+            EntryType type = convertFileStatus(it->symlink_status(error));
+            if (maxDepth >= 0 && it.depth() + 1 >= maxDepth)
+            {
+                it.disable_recursion_pending();
+            }
+            if (types & type)
+            {
+                result.push_back(DirectoryEntry{.path = it->path().string(), .type = type});
+            }
+        }
+        std::sort(result.begin(), result.end(), [](DirectoryEntry const &a, DirectoryEntry const &b)
+                  { return a.path < b.path; });
+        return result;
+    }
+#endif
+
+    std::error_code copyPath(std::filesystem::path const &from, std::filesystem::path const &to)
+    {
+        std::error_code error;
+        std::filesystem::path target = getTargetPath(from, to);
+        std::filesystem::file_status status = std::filesystem::symlink_status(from, error);
+        if (error)
+        {
+            return error;
+        }
+        // checked before anything is created, so that directories copied onto themselves aren't partially copied either
+        if (std::filesystem::equivalent(from, target, error))
+        {
+            return makeError(Error::SameFile);
+        }
+        error.clear();
+        if (std::filesystem::is_symlink(status))
+        {
+            std::filesystem::copy_symlink(from, target, error);
+            return error;
+        }
+        if (!std::filesystem::is_directory(status))
+        {
+            return copyFile(from, target);
+        }
+        // directory copied somewhere inside of itself would keep finding the copies it just made
+        std::error_code sourceError, targetError;
+        std::filesystem::path source = std::filesystem::weakly_canonical(from, sourceError);
+        std::filesystem::path resolvedTarget = std::filesystem::weakly_canonical(target, targetError);
+        if (!sourceError && !targetError && std::mismatch(source.begin(), source.end(), resolvedTarget.begin(), resolvedTarget.end()).first == source.end())
+        {
+            return makeError(Error::CopyIntoItself);
+        }
+        std::filesystem::create_directories(target, error);
+        if (error)
+        {
+            return error;
+        }
+        for (std::filesystem::recursive_directory_iterator it(from, error), end; !error && it != end; it.increment(error))
+        {
+            // this runs on worker threads of batch operations, where an exception would terminate the process
+            std::filesystem::path entryTarget = target / std::filesystem::relative(it->path(), from, error);
+            if (error)
+            {
+                break;
+            }
+            std::filesystem::file_status entryStatus = it->symlink_status(error);
+            if (error)
+            {
+                break;
+            }
+            if (std::filesystem::is_symlink(entryStatus))
+            {
+                std::filesystem::copy_symlink(it->path(), entryTarget, error);
+            }
+            else if (std::filesystem::is_directory(entryStatus))
+            {
+                std::filesystem::create_directories(entryTarget, error);
+            }
+            else
+            {
+                error = copyFile(it->path(), entryTarget);
+            }
+        }
+        return error;
+    }
+
+    std::error_code movePath(std::filesystem::path const &from, std::filesystem::path const &to)
+    {
+        std::error_code error;
+        std::filesystem::path target = getTargetPath(from, to);
+        std::filesystem::rename(from, target, error);
+        if (error != std::errc::cross_device_link)
+        {
+            return error;
+        }
+        // rename can't move data between file systems
+        if ((error = copyPath(from, target)))
+        {
+            return error;
+        }
+        return removePath(from);
+    }
+
+    std::error_code removePath(std::filesystem::path const &path)
+    {
+        std::error_code error;
+        if (std::filesystem::remove_all(path, error) == 0 && !error)
+        {
+            return std::make_error_code(std::errc::no_such_file_or_directory);
+        }
+        return error;
+    }
+} // namespace GobScriptHelper::FileSystem
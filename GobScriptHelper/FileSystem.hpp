@@ -0,0 +1,90 @@
+#pragma once
+#include <filesystem>
+#include <system_error>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+/// @brief File operations done inside the interpreter process, so that simple tasks like copying a file don't require starting a program
+namespace GobScriptHelper::FileSystem
+{
+    /// @brief Kind of directory entry, values are bit flags so that several kinds can be combined into a filter
+    enum EntryType : uint8_t
+    {
+        File = 1 << 0,
+        Directory = 1 << 1,
+        Symlink = 1 << 2,
+        /// @brief Devices, sockets, pipes and such
+        Other = 1 << 3,
+        AnyEntry = File | Directory | Symlink | Other,
+    };
+
+    struct DirectoryEntry
+    {
+        std::string path;
+        EntryType type;
+    };
+
+    /// @brief Create directory together with all missing parent directories, same as `mkdir -p`
+    /// @param path Path to the directory
+    /// @return Error or empty error code on success. Directory that already exists is not an error
+    std::error_code makeDirectory(std::filesystem::path const &path);
+
+    /// @brief Copy contents of a single file. File system is first asked to make a reflink copy that shares data with the original,
+    /// otherwise data is copied by the kernel with copy_file_range when possible, so it doesn't pass through user space
+    /// @param from Path to the file to copy
+    /// @param to Path to the new file, existing file is overwritten
+    /// @return Error or empty error code on success
+    std::error_code copyFile(std::filesystem::path const &from, std::filesystem::path const &to);
+
+    /// @brief Copy file or the whole directory, same as `cp -r`. If target is an existing directory the copy is placed inside of it
+    /// @param from Path to copy
+    /// @param to Target path
+    /// @return Error or empty error code on success. Copying a path onto itself or a directory inside of itself is an error and nothing is copied
+    std::error_code copyPath(std::filesystem::path const &from, std::filesystem::path const &to);
+
+    /// @brief Move file or directory, same as `mv`. If target is an existing directory the path is moved inside of it.
+    /// Moving between file systems is done by copying and removing the original
+    /// @param from Path to move
+    /// @param to Target path
+    /// @return Error or empty error code on success
+    std::error_code movePath(std::filesystem::path const &from, std::filesystem::path const &to);
+
+    /// @brief Remove file or directory with everything inside of it, same as `rm -r`
+    /// @param path Path to remove
+    /// @return Error or empty error code on success. Path that doesn't exist is an error
+    std::error_code removePath(std::filesystem::path const &path);
+
+    /// @brief Create empty file or update modification time of the existing one, same as `touch`
+    /// @param path Path to the file
+    /// @return Error or empty error code on success
+    std::error_code touchFile(std::filesystem::path const &path);
+
+    /// @brief Write contents of the file into interpreter output, same as `cat`
+    /// @param path Path to the file
+    /// @return Error or empty error code on success
+    std::error_code printFile(std::filesystem::path const &path);
+
+    /// @brief Call the function for every entry of the directory except `.` and `..`, in the order the file system returns them.
+    /// Same as with `walkDirectory`, entry types are taken from the directory listing itself when the file system provides them
+    /// @param path Path to the directory
+    /// @param callback Function called with the name of the entry and its type
+    /// @return False if the directory could not be read
+    bool readDirectory(std::string const &path, std::function<void(char const *name, EntryType type)> const &callback);
+
+    /// @brief Get type of the entry without following symbolic links
+    /// @param path Path to the entry
+    /// @return Type or None if there is no such entry
+    std::optional<EntryType> getEntryType(std::string const &path);
+
+    /// @brief Recursively list everything inside of the directory. Directories are read by several threads at once and entry types are taken from the directory listing itself,
+    /// so no `stat` calls are needed on file systems that report them. Symbolic links are listed but not followed
+    /// @param root Directory to walk
+    /// @param maxDepth How deep to go, 1 lists only direct children of the root and -1 means no limit
+    /// @param types Combination of `EntryType` flags, only entries of these types are returned. Directories are still walked even if they are not returned
+    /// @param maxThreads Maximum amount of threads, 0 to use the default
+    /// @return Entries sorted by path. Directories that can not be read are skipped
+    std::vector<DirectoryEntry> walkDirectory(std::filesystem::path const &root, int64_t maxDepth, uint8_t types, size_t maxThreads = 0);
+} // namespace GobScriptHelper::FileSystem
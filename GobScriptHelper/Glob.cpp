@@ -0,0 +1,438 @@
+#include "Glob.hpp"
+#include "FileSystem.hpp"
+#include "Parallel.hpp"
+#include <algorithm>
+#include <mutex>
+#include <filesystem>
+
+namespace GobScriptHelper::Glob
+{
+    /// @brief Find the brace that closes the one at the start, collecting commas that separate the options
+    /// @return Index of the closing brace or npos if there is none
+    static size_t findClosingBrace(std::string_view pattern, size_t start, std::vector<size_t> &commas)
+    {
+        size_t depth = 0;
+        for (size_t i = start; i < pattern.size(); i++)
+        {
+            switch (pattern[i])
+            {
+            case '\\':
+                i++;
+                break;
+            case '{':
+                depth++;
+                break;
+            case '}':
+                if (--depth == 0)
+                {
+                    return i;
+                }
+                break;
+            case ',':
+                if (depth == 1)
+                {
+                    commas.push_back(i);
+                }
+                break;
+            }
+        }
+        return std::string_view::npos;
+    }
+
+    /// @brief Expand brace sets starting from the given index, `a{b,c{d,e}}` becomes `ab`, `acd` and `ace`
+    static void expandBraces(std::string const &pattern, size_t from, std::vector<std::string> &result)
+    {
+        for (size_t i = from; i < pattern.size(); i++)
+        {
+            if (pattern[i] == '\\')
+            {
+                i++;
+                continue;
+            }
+            if (pattern[i] != '{')
+            {
+                continue;
+            }
+            std::vector<size_t> commas;
+            size_t end = findClosingBrace(pattern, i, commas);
+            // same as in shell, braces without options are left as they are
+            if (end == std::string::npos || commas.empty())
+            {
+                continue;
+            }
+            commas.push_back(end);
+            size_t optionStart = i + 1;
+            for (size_t comma : commas)
+            {
+                expandBraces(pattern.substr(0, i) + pattern.substr(optionStart, comma - optionStart) + pattern.substr(end + 1), i, result);
+                optionStart = comma + 1;
+            }
+            return;
+        }
+        result.push_back(pattern);
+    }
+
+    Pattern::Pattern(std::string_view pattern)
+    {
+        std::vector<std::string> expanded;
+        expandBraces(std::string(pattern), 0, expanded);
+        for (std::string const &text : expanded)
+        {
+            Alternative alternative{.absolute = text.starts_with('/'), .directoryOnly = text.ends_with('/'), .segments = {}};
+            size_t start = 0;
+            while (start <= text.size())
+            {
+                size_t end = std::min(text.find('/', start), text.size());
+                // empty segments come from leading, trailing or repeated slashes, none of which change the meaning
+                if (end > start)
+                {
+                    alternative.segments.push_back(compileSegment(std::string_view(text).substr(start, end - start)));
+                }
+                start = end + 1;
+            }
+            m_alternatives.push_back(std::move(alternative));
+        }
+    }
+
+    std::vector<Pattern::Position> Pattern::getStart(bool absolute) const
+    {
+        std::vector<Position> positions;
+        for (uint32_t i = 0; i < m_alternatives.size(); i++)
+        {
+            if (m_alternatives[i].absolute == absolute)
+            {
+                addPosition(positions, Position{.alternative = i, .segment = 0});
+            }
+        }
+        return positions;
+    }
+
+    std::vector<Pattern::Position> Pattern::advance(std::vector<Position> const &positions, std::string_view name) const
+    {
+        std::vector<Position> next;
+        for (Position position : positions)
+        {
+            if (isEnd(position))
+            {
+                continue;
+            }
+            Segment const &segment = m_alternatives[position.alternative].segments[position.segment];
+            if (!matchSegment(segment, name))
+            {
+                continue;
+            }
+            // `**` stays in place so it can match more directories, the segment after it is already in the list
+            addPosition(next, segment.type == Segment::Type::Recursive ? position : Position{.alternative = position.alternative, .segment = position.segment + 1});
+        }
+        return next;
+    }
+
+    bool Pattern::isMatch(std::vector<Position> const &positions, bool isDirectory) const
+    {
+        return std::any_of(positions.begin(), positions.end(), [this, isDirectory](Position position)
+                           { return isEnd(position) && (isDirectory || !m_alternatives[position.alternative].directoryOnly); });
+    }
+
+    bool Pattern::canDescend(std::vector<Position> const &positions) const
+    {
+        return std::any_of(positions.begin(), positions.end(), [this](Position position)
+                           { return !isEnd(position); });
+    }
+
+    std::optional<std::vector<std::string>> Pattern::getLiteralNames(std::vector<Position> const &positions) const
+    {
+        std::vector<std::string> names;
+        for (Position position : positions)
+        {
+            if (isEnd(position))
+            {
+                continue;
+            }
+            Segment const &segment = m_alternatives[position.alternative].segments[position.segment];
+            if (segment.type != Segment::Type::Literal)
+            {
+                return {};
+            }
+            if (std::find(names.begin(), names.end(), segment.literal) == names.end())
+            {
+                names.push_back(segment.literal);
+            }
+        }
+        return names;
+    }
+
+    Pattern::Segment Pattern::compileSegment(std::string_view text)
+    {
+        if (text == "**")
+        {
+            return Segment{.type = Segment::Type::Recursive};
+        }
+        std::vector<Token> tokens;
+        auto appendCharacter = [&tokens](char c)
+        {
+            if (tokens.empty() || tokens.back().type != Token::Type::Literal)
+            {
+                tokens.push_back(Token{.type = Token::Type::Literal});
+            }
+            tokens.back().literal += c;
+        };
+        for (size_t i = 0; i < text.size(); i++)
+        {
+            switch (text[i])
+            {
+            case '\\':
+                if (i + 1 < text.size())
+                {
+                    i++;
+                }
+                appendCharacter(text[i]);
+                break;
+            case '*':
+                // several stars in a row match the same as one
+                if (tokens.empty() || tokens.back().type != Token::Type::AnyString)
+                {
+                    tokens.push_back(Token{.type = Token::Type::AnyString});
+                }
+                break;
+            case '?':
+                tokens.push_back(Token{.type = Token::Type::AnyCharacter});
+                break;
+            case '[':
+            {
+                size_t j = i + 1;
+                bool negated = j < text.size() && (text[j] == '!' || text[j] == '^');
+                if (negated)
+                {
+                    j++;
+                }
+                std::bitset<256> characters;
+                // `]` right after the opening bracket is a normal character
+                for (size_t first = j; j < text.size() && (text[j] != ']' || j == first); j++)
+                {
+                    unsigned char c = text[j];
+                    if (c == '\\' && j + 1 < text.size())
+                    {
+                        c = text[++j];
+                    }
+                    if (j + 2 < text.size() && text[j + 1] == '-' && text[j + 2] != ']')
+                    {
+                        for (unsigned int range = c; range <= (unsigned char)text[j + 2]; range++)
+                        {
+                            characters.set(range);
+                        }
+                        j += 2;
+                    }
+                    else
+                    {
+                        characters.set(c);
+                    }
+                }
+                if (j >= text.size())
+                {
+                    appendCharacter('[');
+                    break;
+                }
+                if (negated)
+                {
+                    characters.flip();
+                }
+                tokens.push_back(Token{.type = Token::Type::CharacterClass, .characters = characters});
+                i = j;
+                break;
+            }
+            default:
+                appendCharacter(text[i]);
+            }
+        }
+        if (tokens.size() == 1 && tokens[0].type == Token::Type::Literal)
+        {
+            return Segment{.type = Segment::Type::Literal, .literal = std::move(tokens[0].literal)};
+        }
+        if (tokens.size() == 1 && tokens[0].type == Token::Type::AnyString)
+        {
+            return Segment{.type = Segment::Type::Any};
+        }
+        if (tokens.size() == 2 && tokens[0].type == Token::Type::AnyString && tokens[1].type == Token::Type::Literal)
+        {
+            return Segment{.type = Segment::Type::Suffix, .literal = std::move(tokens[1].literal)};
+        }
+        return Segment{.type = Segment::Type::Wildcard, .tokens = std::move(tokens)};
+    }
+
+    bool Pattern::matchTokens(std::vector<Token> const &tokens, std::string_view name)
+    {
+        size_t token = 0;
+        size_t offset = 0;
+        // only the last star has to be retried on mismatch, since everything between stars has fixed length
+        size_t starToken = std::string_view::npos;
+        size_t starOffset = 0;
+        while (token < tokens.size() || offset < name.size())
+        {
+            if (token < tokens.size())
+            {
+                Token const &current = tokens[token];
+                switch (current.type)
+                {
+                case Token::Type::AnyString:
+                    starToken = token++;
+                    starOffset = offset;
+                    continue;
+                case Token::Type::AnyCharacter:
+                    if (offset < name.size())
+                    {
+                        token++;
+                        offset++;
+                        continue;
+                    }
+                    break;
+                case Token::Type::CharacterClass:
+                    if (offset < name.size() && current.characters.test((unsigned char)name[offset]))
+                    {
+                        token++;
+                        offset++;
+                        continue;
+                    }
+                    break;
+                case Token::Type::Literal:
+                    if (name.substr(offset).starts_with(current.literal))
+                    {
+                        token++;
+                        offset += current.literal.size();
+                        continue;
+                    }
+                    break;
+                }
+            }
+            if (starToken == std::string_view::npos || starOffset >= name.size())
+            {
+                return false;
+            }
+            token = starToken + 1;
+            offset = ++starOffset;
+        }
+        return true;
+    }
+
+    bool Pattern::matchSegment(Segment const &segment, std::string_view name)
+    {
+        if (name.starts_with('.'))
+        {
+            bool explicitDot = segment.type == Segment::Type::Literal ||
+                               (segment.type == Segment::Type::Wildcard && segment.tokens[0].type == Token::Type::Literal && segment.tokens[0].literal.starts_with('.'));
+            if (!explicitDot)
+            {
+                return false;
+            }
+        }
+        switch (segment.type)
+        {
+        case Segment::Type::Literal:
+            return name == segment.literal;
+        case Segment::Type::Suffix:
+            return name.ends_with(segment.literal);
+        case Segment::Type::Any:
+        case Segment::Type::Recursive:
+            return true;
+        default:
+            return matchTokens(segment.tokens, name);
+        }
+    }
+
+    void Pattern::addPosition(std::vector<Position> &positions, Position position) const
+    {
+        while (std::find(positions.begin(), positions.end(), position) == positions.end())
+        {
+            positions.push_back(position);
+            if (isEnd(position) || m_alternatives[position.alternative].segments[position.segment].type != Segment::Type::Recursive)
+            {
+                return;
+            }
+            position.segment++;
+        }
+    }
+
+    bool Pattern::isEnd(Position position) const
+    {
+        return position.segment >= m_alternatives[position.alternative].segments.size();
+    }
+
+    /// @brief Shared state of a single search
+    struct PathSearch
+    {
+        Parallel::WorkStealingPool &pool;
+        Pattern const &pattern;
+        std::mutex resultMutex;
+        std::vector<std::string> result;
+    };
+
+    /// @brief Match entries of one directory, submitting a new task for each subdirectory that can contain matches
+    /// @param prefix Path of the directory ending with `/`, or empty string for the current directory
+    static void searchDirectory(PathSearch &search, std::string const &prefix, std::vector<Pattern::Position> const &positions)
+    {
+        std::vector<std::string> found;
+        auto visit = [&](std::string_view name, FileSystem::EntryType type)
+        {
+            std::vector<Pattern::Position> next = search.pattern.advance(positions, name);
+            if (next.empty())
+            {
+                return;
+            }
+            std::string path = prefix + std::string(name);
+            bool isDirectory = type == FileSystem::EntryType::Directory;
+            if (isDirectory && search.pattern.canDescend(next))
+            {
+                search.pool.submit([&search, directory = path + "/", next]()
+                                   { searchDirectory(search, directory, next); });
+            }
+            if (search.pattern.isMatch(next, isDirectory))
+            {
+                found.push_back(std::move(path));
+            }
+        };
+        if (std::optional<std::vector<std::string>> names = search.pattern.getLiteralNames(positions); names.has_value())
+        {
+            for (std::string const &name : names.value())
+            {
+                std::optional<FileSystem::EntryType> type = FileSystem::getEntryType(prefix + name);
+                if (!type.has_value())
+                {
+                    continue;
+                }
+                // names written out in the pattern are followed like in shell, so `/tmp/*` works when /tmp is a link
+                std::error_code ignored;
+                if (type == FileSystem::EntryType::Symlink && std::filesystem::is_directory(prefix + name, ignored))
+                {
+                    type = FileSystem::EntryType::Directory;
+                }
+                visit(name, type.value());
+            }
+        }
+        else
+        {
+            FileSystem::readDirectory(prefix.empty() ? "." : prefix, visit);
+        }
+        if (!found.empty())
+        {
+            std::lock_guard<std::mutex> lock(search.resultMutex);
+            search.result.insert(search.result.end(), std::make_move_iterator(found.begin()), std::make_move_iterator(found.end()));
+        }
+    }
+
+    std::vector<std::string> findPaths(Pattern const &pattern, size_t maxThreads)
+    {
+        Parallel::WorkStealingPool pool(maxThreads);
+        PathSearch search{.pool = pool, .pattern = pattern};
+        for (bool absolute : {false, true})
+        {
+            if (std::vector<Pattern::Position> start = pattern.getStart(absolute); !start.empty())
+            {
+                pool.submit([&search, prefix = std::string(absolute ? "/" : ""), start = std::move(start)]()
+                            { searchDirectory(search, prefix, start); });
+            }
+        }
+        pool.waitIdle();
+        std::sort(search.result.begin(), search.result.end());
+        search.result.erase(std::unique(search.result.begin(), search.result.end()), search.result.end());
+        return std::move(search.result);
+    }
+} // namespace GobScriptHelper::Glob
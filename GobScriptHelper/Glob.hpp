@@ -0,0 +1,120 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <bitset>
+#include <optional>
+#include <cstdint>
+#include <compare>
+
+/// @brief Selecting paths with shell style patterns such as `music/**/*.{flac,ogg}`
+namespace GobScriptHelper::Glob
+{
+    /// @brief Pattern compiled once and then matched against path components one at a time, so directories that can't contain matches are never read
+    class Pattern
+    {
+    public:
+        /// @brief Place in the pattern, which is the segment of one of the alternatives that the next path component has to match
+        struct Position
+        {
+            uint32_t alternative;
+            uint32_t segment;
+
+            auto operator<=>(Position const &) const = default;
+        };
+
+        /// @brief Compile the pattern. Brace sets are expanded into separate alternatives which are split into segments by `/`.
+        /// Same as in shell, brackets and braces that are not closed are treated as normal characters
+        /// @param pattern
+        explicit Pattern(std::string_view pattern);
+
+        /// @brief Get positions at the start of the pattern
+        /// @param absolute If true positions of alternatives that start with `/` are returned, otherwise of those relative to the current directory
+        std::vector<Position> getStart(bool absolute) const;
+
+        /// @brief Get positions after the name of an entry is matched against the current positions
+        /// @param positions Current positions
+        /// @param name Name of the entry
+        /// @return Positions that accept the name, empty if nothing inside of the entry can match
+        std::vector<Position> advance(std::vector<Position> const &positions, std::string_view name) const;
+
+        /// @brief Check if the entry that produced the positions matches the whole pattern
+        /// @param positions Positions returned by `advance`
+        /// @param isDirectory Whether the entry is a directory, since patterns ending with `/` only match directories
+        bool isMatch(std::vector<Position> const &positions, bool isDirectory) const;
+
+        /// @brief Check if entries inside of the directory that produced the positions can match
+        bool canDescend(std::vector<Position> const &positions) const;
+
+        /// @brief If all positions accept only exact names, get those names, so that the directory doesn't have to be read
+        /// @return Names or None if any position contains a wildcard
+        std::optional<std::vector<std::string>> getLiteralNames(std::vector<Position> const &positions) const;
+
+    private:
+        struct Token
+        {
+            enum class Type
+            {
+                Literal,
+                /// @brief `?`
+                AnyCharacter,
+                /// @brief `*`
+                AnyString,
+                /// @brief `[...]`
+                CharacterClass,
+            };
+            Type type;
+            std::string literal = {};
+            std::bitset<256> characters = {};
+        };
+
+        struct Segment
+        {
+            enum class Type
+            {
+                /// @brief Name without any wildcards, compared directly
+                Literal,
+                /// @brief `*` followed by a literal such as `*.flac`, checked by comparing the end of the name
+                Suffix,
+                /// @brief `*` that matches any name
+                Any,
+                /// @brief `**` that matches any amount of directories
+                Recursive,
+                /// @brief Anything else, matched token by token
+                Wildcard,
+            };
+            Type type;
+            std::string literal = {};
+            std::vector<Token> tokens = {};
+        };
+
+        struct Alternative
+        {
+            bool absolute;
+            /// @brief Pattern ended with `/`
+            bool directoryOnly;
+            std::vector<Segment> segments;
+        };
+
+        static Segment compileSegment(std::string_view text);
+
+        static bool matchTokens(std::vector<Token> const &tokens, std::string_view name);
+
+        /// @brief Check if the name matches the segment, names starting with `.` only match segments that start with `.` too
+        static bool matchSegment(Segment const &segment, std::string_view name);
+
+        /// @brief Add position to the list together with positions after `**` segments, since those can match no directories at all
+        void addPosition(std::vector<Position> &positions, Position position) const;
+
+        bool isEnd(Position position) const;
+
+        std::vector<Alternative> m_alternatives;
+    };
+
+    /// @brief Find all paths that match the pattern. Directories are read by several threads at once and only directories that can contain matches are read.
+    /// Symbolic links are matched but not followed, and hidden entries are only matched by segments that start with `.`
+    /// @param pattern Compiled pattern
+    /// @param maxThreads Maximum amount of threads, 0 to use the default
+    /// @return Matching paths sorted, written the same way as in the pattern
+    std::vector<std::string> findPaths(Pattern const &pattern, size_t maxThreads = 0);
+} // namespace GobScriptHelper::Glob
@@ -2,6 +2,7 @@
 #include <iostream>
 #include "../Pigeon/State.hpp"
 #include "../Pigeon/Parser.hpp"
+#include "../Pigeon/Program.hpp"
 #include "StandardFunctions.hpp"
 #include "Terminal.hpp"
 
@@ -46,6 +47,8 @@ int GobScriptHelper::Interactive::runInteractiveMode()
 
     while (true)
     {
+        // every input is kept alive by the state, since functions declared in it are parsed from its code when first called
+        std::shared_ptr<Program> input;
         try
         {
             std::cout << ">>";
@@ -58,18 +61,20 @@ int GobScriptHelper::Interactive::runInteractiveMode()
                 program += temp;
             } while (!isCompleteCodeString(program.begin(), program.end()));
             program += '\n';
-            loadString(program)->execute(state);
+            input = std::make_shared<Program>(program);
+            input->parse();
+            input->execute(state);
             std::cout << std::endl;
         }
         // we don't exit on error, because we are supposed to run the code forever
         // this is more so to mimic how python one works
         catch (ParsingError e)
         {
-            displayError(e.getIterator() - program.begin(), program, e.what());
+            displayError(e.getIterator() - input->getCode().begin(), input->getCode(), e.what());
         }
         catch (RuntimeError e)
         {
-            displayError(e.getIterator() - program.begin(), program, e.what());
+            displayError(e.getIterator() - input->getCode().begin(), input->getCode(), e.what());
         }
         program.clear();
     }
@@ -0,0 +1,181 @@
+#include "Parallel.hpp"
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace GobScriptHelper::Parallel
+{
+    size_t getDefaultThreadCount()
+    {
+        // hardware_concurrency is allowed to return 0 if it can't tell
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+
+    void forEachIndex(size_t count, std::function<void(size_t index)> const &task, size_t maxThreads)
+    {
+        size_t threadCount = std::min(maxThreads == 0 ? getDefaultThreadCount() : maxThreads, count);
+        std::atomic<size_t> next = 0;
+        auto worker = [&]()
+        {
+            for (size_t i = next++; i < count; i = next++)
+            {
+                task(i);
+            }
+        };
+        std::vector<std::thread> threads;
+        // calling thread works too, so one thread less has to be started
+        for (size_t i = 1; i < threadCount; i++)
+        {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (std::thread &thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    /// @brief Pool that the current thread works for, used to put tasks submitted from inside tasks into the queue of the thread
+    static thread_local WorkStealingPool *CurrentPool = nullptr;
+    /// @brief Index of the queue of the current thread in its pool
+    static thread_local size_t CurrentQueueIndex = 0;
+
+    WorkStealingPool::WorkStealingPool(size_t threadCount)
+    {
+        threadCount = threadCount == 0 ? getDefaultThreadCount() : threadCount;
+        for (size_t i = 0; i <= threadCount; i++)
+        {
+            m_queues.push_back(std::make_unique<TaskQueue>());
+        }
+        for (size_t i = 0; i < threadCount; i++)
+        {
+            m_threads.emplace_back(&WorkStealingPool::runWorker, this, i);
+        }
+    }
+
+    void WorkStealingPool::submit(std::function<void()> task)
+    {
+        size_t queueIndex = CurrentPool == this ? CurrentQueueIndex : m_queues.size() - 1;
+        m_unfinished++;
+        // counted before the task becomes visible, otherwise another thread could take it and decrease the counter first
+        m_queued++;
+        {
+            std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+            m_queues[queueIndex]->tasks.push_back(std::move(task));
+        }
+        {
+            // taking the lock makes sure that sleeping threads either see the new task or get the notification
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_wake.notify_one();
+        m_idle.notify_all();
+    }
+
+    void WorkStealingPool::waitIdle()
+    {
+        size_t queueIndex = CurrentPool == this ? CurrentQueueIndex : m_queues.size() - 1;
+        while (m_unfinished > 0)
+        {
+            if (std::function<void()> task = findTask(queueIndex); task)
+            {
+                runTask(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_idle.wait(lock, [this]()
+                        { return m_unfinished == 0 || m_queued > 0; });
+        }
+    }
+
+    void WorkStealingPool::waitUntil(std::function<bool()> const &isDone)
+    {
+        size_t queueIndex = CurrentPool == this ? CurrentQueueIndex : m_queues.size() - 1;
+        while (!isDone())
+        {
+            if (std::function<void()> task = findTask(queueIndex); task)
+            {
+                runTask(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_idle.wait(lock, [this, &isDone]()
+                        { return isDone() || m_queued > 0; });
+        }
+    }
+
+    WorkStealingPool::~WorkStealingPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+            m_stopping = true;
+        }
+        m_wake.notify_all();
+        for (std::thread &thread : m_threads)
+        {
+            thread.join();
+        }
+    }
+
+    std::function<void()> WorkStealingPool::findTask(size_t queueIndex)
+    {
+        std::function<void()> task;
+        {
+            // own queue is used like a stack, so the most recently found work which is likely still in cache runs first
+            std::lock_guard<std::mutex> lock(m_queues[queueIndex]->mutex);
+            if (!m_queues[queueIndex]->tasks.empty())
+            {
+                task = std::move(m_queues[queueIndex]->tasks.back());
+                m_queues[queueIndex]->tasks.pop_back();
+            }
+        }
+        // other queues are stolen from the opposite end, where the oldest and usually largest pieces of work are
+        for (size_t i = 1; !task && i < m_queues.size(); i++)
+        {
+            TaskQueue &victim = *m_queues[(queueIndex + i) % m_queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                task = std::move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (task)
+        {
+            m_queued--;
+        }
+        return task;
+    }
+
+    void WorkStealingPool::runTask(std::function<void()> const &task)
+    {
+        task();
+        --m_unfinished;
+        // threads in waitUntil can be waiting for any task, not only the last one
+        {
+            std::lock_guard<std::mutex> lock(m_sleepMutex);
+        }
+        m_idle.notify_all();
+    }
+
+    void WorkStealingPool::runWorker(size_t queueIndex)
+    {
+        CurrentPool = this;
+        CurrentQueueIndex = queueIndex;
+        while (true)
+        {
+            if (std::function<void()> task = findTask(queueIndex); task)
+            {
+                runTask(task);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(m_sleepMutex);
+            m_wake.wait(lock, [this]()
+                        { return m_stopping || m_queued > 0; });
+            if (m_stopping)
+            {
+                return;
+            }
+        }
+    }
+} // namespace GobScriptHelper::Parallel
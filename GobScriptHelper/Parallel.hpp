@@ -0,0 +1,82 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+
+namespace GobScriptHelper::Parallel
+{
+    /// @brief Get amount of threads that should be used for work that can be split between all cores
+    size_t getDefaultThreadCount();
+
+    /// @brief Call function for every index in [0, count) using several threads. Each thread takes the next index once it's done with the previous one,
+    /// so slow items don't hold up the rest. Returns once all items are done
+    /// @param count Amount of items
+    /// @param task Function called with index of the item, can be called from several threads at once and must not throw
+    /// @param maxThreads Maximum amount of threads, 0 to use the default
+    void forEachIndex(size_t count, std::function<void(size_t index)> const &task, size_t maxThreads = 0);
+
+    /// @brief Pool of threads for work that is discovered while running, such as subdirectories found while reading a directory.
+    /// Every thread has its own queue, new tasks go into the queue of the thread that created them and threads that run out of work take tasks from others,
+    /// so threads rarely fight over the same queue
+    class WorkStealingPool
+    {
+    public:
+        /// @brief Start the threads of the pool
+        /// @param threadCount Amount of threads, 0 to use the default
+        explicit WorkStealingPool(size_t threadCount = 0);
+
+        WorkStealingPool(WorkStealingPool const &) = delete;
+
+        /// @brief Add task to the pool. Tasks can be submitted from inside other tasks
+        /// @param task Function to run, must not throw
+        void submit(std::function<void()> task);
+
+        /// @brief Block until all submitted tasks and tasks submitted by them have finished. Calling thread runs tasks as well while waiting
+        void waitIdle();
+
+        /// @brief Block until the condition is true. Calling thread runs tasks while waiting, so tasks can wait for tasks they submitted
+        /// without taking a thread out of the pool
+        /// @param isDone Condition checked after every finished task, becomes true once one of the tasks makes it true
+        void waitUntil(std::function<bool()> const &isDone);
+
+        /// @brief Stops the threads, tasks that didn't start yet are dropped
+        ~WorkStealingPool();
+
+    private:
+        struct TaskQueue
+        {
+            std::mutex mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        /// @brief Take task from the own queue or steal one from other queues
+        /// @param queueIndex Index of the queue that belongs to the calling thread
+        /// @return Task or empty function if there is no work
+        std::function<void()> findTask(size_t queueIndex);
+
+        /// @brief Run task and update the amount of unfinished tasks
+        void runTask(std::function<void()> const &task);
+
+        void runWorker(size_t queueIndex);
+
+        /// @brief One queue per thread and one more for threads that don't belong to the pool
+        std::vector<std::unique_ptr<TaskQueue>> m_queues;
+        std::vector<std::thread> m_threads;
+        /// @brief Tasks that were submitted but haven't finished yet
+        std::atomic<size_t> m_unfinished = 0;
+        /// @brief Tasks that are waiting in the queues
+        std::atomic<size_t> m_queued = 0;
+        std::mutex m_sleepMutex;
+        /// @brief Signalled when new task is added or pool is stopped
+        std::condition_variable m_wake;
+        /// @brief Signalled when new task is added or a task is finished
+        std::condition_variable m_idle;
+        bool m_stopping = false;
+    };
+} // namespace GobScriptHelper::Parallel
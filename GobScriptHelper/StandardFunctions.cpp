@@ -4,10 +4,22 @@
 #include "../Pigeon/Error.hpp"
 #include "../Pigeon/Array.hpp"
 #include "../Pigeon/Parser.hpp"
+#include "../Pigeon/Process.hpp"
+#include "../Pigeon/Sequence.hpp"
+#include "../Pigeon/FileReader.hpp"
+#include "../Pigeon/Isolate.hpp"
+#include "FileSystem.hpp"
+#include "Glob.hpp"
+#include "Parallel.hpp"
 #include <filesystem>
 #include <fstream>
 #include <algorithm>
 #include <sstream>
+#include <thread>
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+#include <unistd.h>
+#include <fcntl.h>
+#endif
 
 State GobScriptHelper::prepareScriptState()
 {
@@ -30,22 +42,60 @@ State GobScriptHelper::prepareScriptState()
                   nativeConvertCharIntToAsciiString,
                   nativeConvertCharStringToAsciiInt,
                   nativePrintFunction,
-                  nativeExit});
-}
-
-std::unique_ptr<Action> GobScriptHelper::loadString(std::string const &code)
-{
-    std::string::const_iterator start = code.begin();
-    std::vector<std::unique_ptr<Action>> acts = Pigeon::Parser::parseTopLevelDeclarations(start, code.end());
-
-    return std::make_unique<SequenceAction>(start, std::move(acts));
-}
-
-std::unique_ptr<Action> GobScriptHelper::loadFile(std::string const &filepath)
-{
-    std::ifstream codeFile(filepath);
-
-    return loadString(std::string{std::istreambuf_iterator<char>(codeFile), std::istreambuf_iterator<char>()});
+                  nativeExit,
+                  nativeExecParallel,
+                  nativePipeline,
+                  nativeExecAsync,
+                  nativeExecPoll,
+                  nativeExecWait,
+                  nativeExecLines,
+                  nativeCommandCacheStats,
+                  nativeClearCommandCache,
+                  nativeCommandReport,
+                  nativeExecTimeout,
+                  nativeCoprocessOpen,
+                  nativeCoprocessWrite,
+                  nativeCoprocessRead,
+                  nativeCoprocessClose,
+                  nativeMakeDirectory,
+                  nativeCopyPath,
+                  nativeMovePath,
+                  nativeRemovePath,
+                  nativeTouchFile,
+                  nativePrintFile,
+                  nativeCopyFiles,
+                  nativeMoveFiles,
+                  nativeRemovePaths,
+                  nativeWalkDirectory,
+                  nativeStatCache,
+                  nativeStatInvalidate,
+                  nativeStat,
+                  nativeLazy,
+                  nativeIterateDirectory,
+                  nativeTake,
+                  nativeForce,
+                  nativeEach,
+                  nativeReadFile,
+                  nativeFileLines,
+                  nativeFileOpen,
+                  nativeFileAppend,
+                  nativeFileWrite,
+                  nativeFileFlush,
+                  nativeFileClose,
+                  nativeChannel,
+                  nativeChannelSend,
+                  nativeChannelReceive,
+                  nativeChannelClose,
+                  nativeIsolate,
+                  nativeIsolateJoin,
+                  nativeParallelMap,
+                  nativeSpawn,
+                  nativeJoin,
+                  nativeGlob,
+                  nativeRegexMatch,
+                  nativeRegexSearch,
+                  nativeRegexReplace,
+                  nativeRegexSplit});
 }
 
 std::optional<GobScriptHelper::ScriptFunction> GobScriptHelper::getCallableFunction(State &state, size_t id, bool native)
@@ -80,7 +130,10 @@ Value GobScriptHelper::callScriptFunction(State &state, ScriptFunction const &f,
         }
         state.pushVariableScope(values);
         r = func.body->execute(state);
+        // result has to survive the garbage collection that happens when scope is removed
+        increaseValueRefCount(r);
         state.popVariableScope();
+        decreaseValueRefCount(r);
 
         for (auto const &v : values)
         {
@@ -102,6 +155,127 @@ Value GobScriptHelper::callScriptFunction(State &state, ScriptFunction const &f,
     return r;
 }
 
+/// @brief Produce elements of the sequence one at a time, passing each through all stages of the sequence before reading the next one.
+/// Nothing is kept between elements, so memory use doesn't depend on the length of the sequence
+/// @param state
+/// @param sequence
+/// @param consumer Called with every element that made it through all stages, returns false to stop the iteration
+static void iterateSequence(State &state, SequenceNode const *sequence, std::function<bool(Value)> const &consumer)
+{
+    using namespace GobScriptHelper;
+    std::vector<SequenceStage> const &stages = sequence->getStages();
+    std::vector<std::optional<ScriptFunction>> functions;
+    bool onlyNativeFunctions = true;
+    for (SequenceStage const &stage : stages)
+    {
+        if (stage.type == SequenceStageType::Take)
+        {
+            functions.push_back(std::nullopt);
+            continue;
+        }
+        std::optional<ScriptFunction> func = getCallableFunction(state, stage.function.id, stage.function.native);
+        if (!func.has_value())
+        {
+            throw RuntimeActionExecutionError("Referenced function not found");
+        }
+        onlyNativeFunctions = onlyNativeFunctions && stage.function.native;
+        functions.push_back(func);
+    }
+    // how many elements went through each take stage
+    std::vector<size_t> passed(stages.size(), 0);
+    auto hasMore = [&]()
+    {
+        for (size_t i = 0; i < stages.size(); i++)
+        {
+            if (stages[i].type == SequenceStageType::Take && passed[i] >= stages[i].limit)
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto process = [&](Value element)
+    {
+        for (size_t i = 0; i < stages.size(); i++)
+        {
+            switch (stages[i].type)
+            {
+            case SequenceStageType::Map:
+                element = callScriptFunction(state, functions[i].value(), {element});
+                break;
+            case SequenceStageType::Filter:
+                if (isValueNull(callScriptFunction(state, functions[i].value(), {element})))
+                {
+                    return true;
+                }
+                break;
+            case SequenceStageType::Take:
+                passed[i]++;
+                break;
+            }
+        }
+        return consumer(element);
+    };
+    size_t count = 0;
+    // user functions clean up memory on return, but native ones don't. Collection only happens between elements, when nothing is in flight
+    auto collectGarbage = [&]()
+    {
+        if (onlyNativeFunctions && ++count % 1024 == 0)
+        {
+            state.collectGarbage();
+        }
+    };
+    if (ArrayNode const *array = sequence->getArray(); array != nullptr)
+    {
+        for (size_t i = 0; i < array->getLen() && hasMore(); i++)
+        {
+            collectGarbage();
+            if (!process(array->getValueAt(i).value()))
+            {
+                return;
+            }
+        }
+        return;
+    }
+    std::error_code error;
+    if (sequence->getSourceType() == SequenceSourceType::FileLines)
+    {
+        Pigeon::LineReader reader(sequence->getPath());
+        std::string line;
+        while (hasMore() && reader.next(line))
+        {
+            collectGarbage();
+            if (!process(state.createString(std::move(line))))
+            {
+                return;
+            }
+        }
+        return;
+    }
+    for (std::filesystem::directory_iterator it(sequence->getPath(), error), end; !error && it != end && hasMore(); it.increment(error))
+    {
+        collectGarbage();
+        if (!process(state.createString(it->path().string())))
+        {
+            return;
+        }
+    }
+}
+
+/// @brief Get sequence that goes over the value, which must be either array or sequence
+static SequenceNode *getSequenceArgument(State &state, Value const &value)
+{
+    switch (value.index())
+    {
+    case ValueType::Array:
+        return state.createSequence(getValueAsArray(value));
+    case ValueType::Sequence:
+        return getValueAsSequence(value);
+    default:
+        throw RuntimeActionExecutionError("Expected array or sequence");
+    }
+}
+
 Value GobScriptHelper::nativePrintLineFunction(State &state, std::vector<Value> const &args)
 {
     for (Value const &v : args)
@@ -136,6 +310,15 @@ Value GobScriptHelper::nativeLenFunction(State &state, std::vector<Value> const
         return Value((int64_t)std::get<StringNode *>(v)->getLen());
     case ValueType::Array:
         return Value((int64_t)std::get<ArrayNode *>(v)->getLen());
+    case ValueType::Sequence:
+    {
+        // length of the sequence is unknown until all of its stages are run
+        int64_t count = 0;
+        iterateSequence(state, getValueAsSequence(v), [&count](Value)
+                        { count++;
+                          return true; });
+        return Value(count);
+    }
     }
     return Value();
 }
@@ -147,7 +330,7 @@ Value GobScriptHelper::nativeGetFileNameSuffix(State &state, std::vector<Value>
     {
         throw RuntimeActionExecutionError("Expected string");
     }
-    return state.createString(std::filesystem::path(getValueAsString(v)->getValue()).extension().string());
+    return state.createString(std::filesystem::path(getValueAsString(v)->getView()).extension().string());
 }
 
 Value GobScriptHelper::nativeGetFileName(State &state, std::vector<Value> const &args)
@@ -157,7 +340,7 @@ Value GobScriptHelper::nativeGetFileName(State &state, std::vector<Value> const
     {
         throw RuntimeActionExecutionError("Expected string");
     }
-    return state.createString(std::filesystem::path(getValueAsString(v)->getValue()).filename().string());
+    return state.createString(std::filesystem::path(getValueAsString(v)->getView()).filename().string());
 }
 
 Value GobScriptHelper::nativeGetFileNameStem(State &state, std::vector<Value> const &args)
@@ -167,13 +350,22 @@ Value GobScriptHelper::nativeGetFileNameStem(State &state, std::vector<Value> co
     {
         throw RuntimeActionExecutionError("Expected string");
     }
-    return state.createString(std::filesystem::path(getValueAsString(v)->getValue()).stem().string());
+    return state.createString(std::filesystem::path(getValueAsString(v)->getView()).stem().string());
 }
 
 Value GobScriptHelper::nativeArrayFilter(State &state, std::vector<Value> const &args)
 {
     Value array = args[0];
     Value callback = args[1];
+    if (array.index() == ValueType::Sequence)
+    {
+        if (callback.index() != ValueType::FunctionRef)
+        {
+            throw RuntimeActionExecutionError("Expected callback filter function");
+        }
+        // nothing is run yet, the function becomes one more stage of the sequence
+        return state.createSequence(*getValueAsSequence(array), SequenceStage{.type = SequenceStageType::Filter, .function = getValueAsFunction(callback)});
+    }
     if (array.index() != ValueType::Array)
     {
         throw RuntimeActionExecutionError("Expected array");
@@ -204,13 +396,22 @@ Value GobScriptHelper::nativeMapArray(State &state, std::vector<Value> const &ar
 {
     Value array = args[0];
     Value callback = args[1];
+    if (array.index() == ValueType::Sequence)
+    {
+        if (callback.index() != ValueType::FunctionRef)
+        {
+            throw RuntimeActionExecutionError("Expected callback map function");
+        }
+        // nothing is run yet, the function becomes one more stage of the sequence
+        return state.createSequence(*getValueAsSequence(array), SequenceStage{.type = SequenceStageType::Map, .function = getValueAsFunction(callback)});
+    }
     if (array.index() != ValueType::Array)
     {
         throw RuntimeActionExecutionError("Expected array");
     }
     if (callback.index() != ValueType::FunctionRef)
     {
-        throw RuntimeActionExecutionError("Expected callback filter function");
+        throw RuntimeActionExecutionError("Expected callback map function");
     }
     ArrayNode const *arr = getValueAsArray(array);
     std::optional<ScriptFunction> func = getCallableFunction(state, getValueAsFunction(callback).id, getValueAsFunction(callback).native);
@@ -239,12 +440,12 @@ Value GobScriptHelper::nativeListDirectory(State &state, std::vector<Value> cons
     {
         throw RuntimeActionExecutionError("Expected folder path");
     }
-    if (!std::filesystem::is_directory(getValueAsString(path)->getValue()))
+    if (state.getStatCache().getStatus(std::string(getValueAsString(path)->getView())).type != Pigeon::FileType::Directory)
     {
         return Value(0);
     }
     std::vector<Value> files;
-    for (const auto &entry : std::filesystem::directory_iterator(getValueAsString(path)->getValue()))
+    for (const auto &entry : std::filesystem::directory_iterator(std::filesystem::path(getValueAsString(path)->getView())))
     {
         files.push_back(state.createString(entry.path().string()));
     }
@@ -258,7 +459,7 @@ Value GobScriptHelper::nativeIsDirectory(State &state, std::vector<Value> const
     {
         throw RuntimeActionExecutionError("Expected folder path");
     }
-    return (int64_t)std::filesystem::is_directory(getValueAsString(path)->getValue());
+    return (int64_t)(state.getStatCache().getStatus(std::string(getValueAsString(path)->getView())).type == Pigeon::FileType::Directory);
 }
 
 Value GobScriptHelper::nativeIsFile(State &state, std::vector<Value> const &args)
@@ -268,7 +469,7 @@ Value GobScriptHelper::nativeIsFile(State &state, std::vector<Value> const &args
     {
         throw RuntimeActionExecutionError("Expected folder path");
     }
-    return (int64_t)std::filesystem::is_regular_file(getValueAsString(path)->getValue());
+    return (int64_t)(state.getStatCache().getStatus(std::string(getValueAsString(path)->getView())).type == Pigeon::FileType::File);
 }
 
 Value GobScriptHelper::nativeAppend(State &state, std::vector<Value> const &args)
@@ -282,7 +483,7 @@ Value GobScriptHelper::nativeAppend(State &state, std::vector<Value> const &args
         {
             throw RuntimeActionExecutionError("Expected string to append");
         }
-        getValueAsString(v)->getValue() += getValueAsString(v2)->getValue();
+        getValueAsString(v)->getValue() += getValueAsString(v2)->getView();
         return v;
         break;
     case ValueType::Array:
@@ -307,7 +508,7 @@ Value GobScriptHelper::nativeAt(State &state, std::vector<Value> const &args)
     {
     case ValueType::String:
 
-        return state.createString(std::string{getValueAsString(v)->getValue()[getValueAsInt(i)]});
+        return state.createString(std::string{getValueAsString(v)->getView()[getValueAsInt(i)]});
         break;
     case ValueType::Array:
         if (std::optional<Value> item = getValueAsArray(v)->getValueAt(getValueAsInt(i)); item.has_value())
@@ -343,11 +544,11 @@ Value GobScriptHelper::nativeSetAt(State &state, std::vector<Value> const &args)
             getValueAsString(array)->getValue()[getValueAsInt(i)] = getValueAsInt(value);
             return value;
         case ValueType::String:
-            if (getValueAsString(value)->getValue().empty())
+            if (getValueAsString(value)->getView().empty())
             {
                 throw RuntimeActionExecutionError("To assign character to string using string value, string must be at least 1 character long. Rest of the string is ignored");
             }
-            getValueAsString(array)->getValue()[getValueAsInt(i)] = getValueAsString(value)->getValue()[0];
+            getValueAsString(array)->getValue()[getValueAsInt(i)] = getValueAsString(value)->getView()[0];
             return value;
         default:
             throw RuntimeActionExecutionError("Expected integer or string for 'set at' operator");
@@ -402,7 +603,23 @@ Value GobScriptHelper::nativeConvertCharStringToAsciiInt(State &state, std::vect
     {
         throw RuntimeActionExecutionError(std::string("Expected single character, but found string of length ") + std::to_string(getValueAsString(str)->getLen()));
     }
-    return (IntegerType)getValueAsString(str)->getValue()[0];
+    return (IntegerType)getValueAsString(str)->getView()[0];
+}
+
+/// @brief Thread that runs the script, which is the only one allowed to end the process
+static std::thread::id const MainThreadId = std::this_thread::get_id();
+
+/// @brief End the process with the exit code. Static objects such as the task pool are destroyed by `exit`, so the process can't end while the call comes from a task,
+/// an isolate or a helper thread. In those cases ExitRequest is thrown instead and the exit happens once the task is joined by the main thread
+[[noreturn]] static void exitScript(State &state, int code)
+{
+    if (std::this_thread::get_id() != MainThreadId || Pigeon::Task::isRunningOnCurrentThread())
+    {
+        throw ExitRequest(code);
+    }
+    // state is not destroyed by exit, but tasks must not keep running while static objects such as the task pool are destroyed
+    state.getTaskManager().stopAll();
+    exit(code);
 }
 
 Value GobScriptHelper::nativeExit(State &state, std::vector<Value> const &args)
@@ -412,5 +629,1117 @@ Value GobScriptHelper::nativeExit(State &state, std::vector<Value> const &args)
     {
         throw RuntimeActionExecutionError("Expected exit code");
     }
-    exit(getValueAsInt(str));
+    exitScript(state, getValueAsInt(str));
+}
+
+/// @brief Value that callbacks return to stop iteration early, since the language has no `break`
+static constexpr IntegerType StopIterationValue = -1;
+
+/// @brief Convert script value into a command, where either the value is an array of program name and arguments or a string containing just the program name
+/// @param val
+/// @return
+static Pigeon::Process::Command convertValueToCommand(Value const &val)
+{
+    if (val.index() == ValueType::String)
+    {
+        return Pigeon::Process::Command{.program = std::string(getValueAsString(val)->getView())};
+    }
+    if (val.index() != ValueType::Array || getValueAsArray(val)->isEmpty())
+    {
+        throw RuntimeActionExecutionError("Expected command as an array containing program name and arguments");
+    }
+    ArrayNode const *arr = getValueAsArray(val);
+    Pigeon::Process::Command command{.program = convertValueToString(arr->getValueAt(0).value())};
+    for (size_t i = 1; i < arr->getLen(); i++)
+    {
+        command.arguments.push_back(convertValueToString(arr->getValueAt(i).value()));
+    }
+    return command;
+}
+
+Value GobScriptHelper::nativeExecParallel(State &state, std::vector<Value> const &args)
+{
+    if (args.empty() || args.size() > 2)
+    {
+        throw RuntimeActionExecutionError("Expected array of commands and optional maximum amount of running commands");
+    }
+    if (args[0].index() != ValueType::Array)
+    {
+        throw RuntimeActionExecutionError("Expected array of commands");
+    }
+    size_t maxJobs = Parallel::getDefaultThreadCount();
+    if (args.size() == 2)
+    {
+        if (args[1].index() != ValueType::Integer || getValueAsInt(args[1]) <= 0)
+        {
+            throw RuntimeActionExecutionError("Expected positive integer for maximum amount of running commands");
+        }
+        maxJobs = getValueAsInt(args[1]);
+    }
+    ArrayNode const *arr = getValueAsArray(args[0]);
+    std::vector<Pigeon::Process::Command> commands;
+    for (size_t i = 0; i < arr->getLen(); i++)
+    {
+        commands.push_back(convertValueToCommand(arr->getValueAt(i).value()));
+    }
+    std::vector<Pigeon::Process::ProcessResult> results = Pigeon::Process::runCommandsInParallel(commands, maxJobs, &state.getCommandPathCache());
+    std::vector<Value> statuses;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        state.getCommandStatistics().record(commands[i].program, results[i]);
+        statuses.push_back((IntegerType)results[i].exitCode);
+    }
+    return state.createArray(statuses);
+}
+
+Value GobScriptHelper::nativePipeline(State &state, std::vector<Value> const &args)
+{
+    if (args.empty())
+    {
+        throw RuntimeActionExecutionError("Expected at least one command");
+    }
+    std::vector<Pigeon::Process::Command> commands;
+    for (Value const &arg : args)
+    {
+        commands.push_back(convertValueToCommand(arg));
+    }
+    std::vector<Pigeon::Process::ProcessResult> results = Pigeon::Process::runPipeline(commands, &state.getCommandPathCache());
+    std::vector<Value> statuses;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        state.getCommandStatistics().record(commands[i].program, results[i]);
+        statuses.push_back((IntegerType)results[i].exitCode);
+    }
+    return state.createArray(statuses);
+}
+
+Value GobScriptHelper::nativeExecAsync(State &state, std::vector<Value> const &args)
+{
+    if (args.empty())
+    {
+        throw RuntimeActionExecutionError("Expected program name");
+    }
+    Pigeon::Process::Command command{.program = convertValueToString(args[0])};
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        command.arguments.push_back(convertValueToString(args[i]));
+    }
+    return (IntegerType)state.getProcessManager().startBackground(command, &state.getCommandPathCache());
+}
+
+Value GobScriptHelper::nativeExecPoll(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected process handle");
+    }
+    if (std::optional<Pigeon::Process::ProcessResult> result = state.getProcessManager().poll(getValueAsInt(args[0])); result.has_value())
+    {
+        return (IntegerType)result.value().exitCode;
+    }
+    return (IntegerType)-1;
+}
+
+Value GobScriptHelper::nativeExecWait(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected process handle");
+    }
+    std::string program = state.getProcessManager().getProgram(getValueAsInt(args[0]));
+    Pigeon::Process::ProcessResult result = state.getProcessManager().wait(getValueAsInt(args[0]));
+    state.getCommandStatistics().record(program, result);
+    return (IntegerType)result.exitCode;
+}
+
+Value GobScriptHelper::nativeExecLines(State &state, std::vector<Value> const &args)
+{
+    if (args.size() < 2 || args[0].index() != ValueType::FunctionRef)
+    {
+        throw RuntimeActionExecutionError("Expected callback function and program name");
+    }
+    std::optional<ScriptFunction> func = getCallableFunction(state, getValueAsFunction(args[0]).id, getValueAsFunction(args[0]).native);
+    if (!func.has_value())
+    {
+        throw RuntimeActionExecutionError("Referenced function not found");
+    }
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+    std::vector<std::string> arguments;
+    for (size_t i = 2; i < args.size(); i++)
+    {
+        arguments.push_back(convertValueToString(args[i]));
+    }
+    int pipefd[2];
+    if (pipe2(pipefd, O_CLOEXEC) == -1)
+    {
+        throw RuntimeActionExecutionError("Failed to create pipe");
+    }
+    Pigeon::Process::SpawnOptions options;
+    options.stdoutFd = pipefd[1];
+    options.pathCache = &state.getCommandPathCache();
+    std::string program = convertValueToString(args[1]);
+    Pigeon::Process::ProcessId pid;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    try
+    {
+        pid = Pigeon::Process::spawnProcess(program, arguments, options);
+    }
+    catch (RuntimeActionExecutionError const &e)
+    {
+        close(pipefd[0]);
+        close(pipefd[1]);
+        throw;
+    }
+    close(pipefd[1]);
+    size_t lineCount = 0;
+    bool finished = false;
+    try
+    {
+        finished = Pigeon::Process::readLines(pipefd[0], [&](std::string_view line)
+                                              {
+                                                  Value result = callScriptFunction(state, func.value(), {state.createString(std::string(line))});
+                                                  // user functions clean up memory on return, but native ones don't
+                                                  if (++lineCount % 1024 == 0 && getValueAsFunction(args[0]).native)
+                                                  {
+                                                      state.collectGarbage();
+                                                  }
+                                                  return result.index() != ValueType::Integer || getValueAsInt(result) != StopIterationValue; });
+    }
+    catch (...)
+    {
+        close(pipefd[0]);
+        Pigeon::Process::terminateProcess(pid);
+        Pigeon::Process::waitForProcess(pid, startTime);
+        throw;
+    }
+    close(pipefd[0]);
+    if (!finished)
+    {
+        Pigeon::Process::terminateProcess(pid);
+    }
+    Pigeon::Process::ProcessResult result = Pigeon::Process::waitForProcess(pid, startTime);
+    state.getCommandStatistics().record(program, result);
+    return (IntegerType)result.exitCode;
+#else
+    throw RuntimeActionExecutionError("Streaming command output is not implemented for this platform");
+#endif
+}
+
+Value GobScriptHelper::nativeCommandCacheStats(State &state, std::vector<Value> const &args)
+{
+    Pigeon::Process::CommandPathCache const &cache = state.getCommandPathCache();
+    return state.createArray({(IntegerType)cache.getHitCount(), (IntegerType)cache.getMissCount(), (IntegerType)cache.getEntryCount()});
+}
+
+Value GobScriptHelper::nativeClearCommandCache(State &state, std::vector<Value> const &args)
+{
+    state.getCommandPathCache().clear();
+    return Value(0);
+}
+
+Value GobScriptHelper::nativeCommandReport(State &state, std::vector<Value> const &args)
+{
+    std::cout.flush();
+    state.getCommandStatistics().printReport(std::cout);
+    return Value(0);
+}
+
+Value GobScriptHelper::nativeExecTimeout(State &state, std::vector<Value> const &args)
+{
+    if (args.size() < 2 || args[0].index() != ValueType::Integer || getValueAsInt(args[0]) < 0)
+    {
+        throw RuntimeActionExecutionError("Expected time limit in milliseconds and program name");
+    }
+    Pigeon::Process::Command command{.program = convertValueToString(args[1])};
+    for (size_t i = 2; i < args.size(); i++)
+    {
+        command.arguments.push_back(convertValueToString(args[i]));
+    }
+    Pigeon::Process::ProcessResult result = Pigeon::Process::runWithTimeout(command, std::chrono::milliseconds(getValueAsInt(args[0])), &state.getCommandPathCache());
+    state.getCommandStatistics().record(command.program, result);
+    return (IntegerType)result.exitCode;
+}
+
+Value GobScriptHelper::nativeCoprocessOpen(State &state, std::vector<Value> const &args)
+{
+    if (args.empty())
+    {
+        throw RuntimeActionExecutionError("Expected program name");
+    }
+    Pigeon::Process::Command command{.program = convertValueToString(args[0])};
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        command.arguments.push_back(convertValueToString(args[i]));
+    }
+    return (IntegerType)state.getCoprocessManager().open(command, &state.getCommandPathCache());
+}
+
+Value GobScriptHelper::nativeCoprocessWrite(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected coprocess handle");
+    }
+    return (IntegerType)(state.getCoprocessManager().writeLine(getValueAsInt(args[0]), convertValueToString(args[1])) ? 0 : -1);
+}
+
+Value GobScriptHelper::nativeCoprocessRead(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected coprocess handle");
+    }
+    if (std::optional<std::string> line = state.getCoprocessManager().readLine(getValueAsInt(args[0])); line.has_value())
+    {
+        return state.createString(std::move(line.value()));
+    }
+    return (IntegerType)-1;
+}
+
+Value GobScriptHelper::nativeCoprocessClose(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected coprocess handle");
+    }
+    std::string program = state.getCoprocessManager().getProgram(getValueAsInt(args[0]));
+    Pigeon::Process::ProcessResult result = state.getCoprocessManager().close(getValueAsInt(args[0]));
+    state.getCommandStatistics().record(program, result);
+    return (IntegerType)result.exitCode;
+}
+
+/// @brief Get path from the argument of a file operation
+static std::string getPathArgument(Value const &arg)
+{
+    if (arg.index() != ValueType::String)
+    {
+        throw RuntimeActionExecutionError("Expected path");
+    }
+    return std::string(getValueAsString(arg)->getView());
+}
+
+/// @brief Convert result of a file operation into value returned to the script, which is 0 on success and error message otherwise
+static Value makeFileOperationResult(State &state, std::error_code const &error, std::string const &path)
+{
+    if (!error)
+    {
+        return Value(0);
+    }
+    return state.createString(path + ": " + error.message());
+}
+
+Value GobScriptHelper::nativeMakeDirectory(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    state.getStatCache().invalidate(path);
+    // missing parents are created as well
+    state.getStatCache().invalidateParents(path);
+    return makeFileOperationResult(state, FileSystem::makeDirectory(path), path);
+}
+
+Value GobScriptHelper::nativeCopyPath(State &state, std::vector<Value> const &args)
+{
+    std::string from = getPathArgument(args[0]);
+    std::string to = getPathArgument(args[1]);
+    state.getStatCache().invalidate(to);
+    return makeFileOperationResult(state, FileSystem::copyPath(from, to), from);
+}
+
+Value GobScriptHelper::nativeMovePath(State &state, std::vector<Value> const &args)
+{
+    std::string from = getPathArgument(args[0]);
+    std::string to = getPathArgument(args[1]);
+    state.getStatCache().invalidate(from);
+    state.getStatCache().invalidate(to);
+    return makeFileOperationResult(state, FileSystem::movePath(from, to), from);
+}
+
+Value GobScriptHelper::nativeRemovePath(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    state.getStatCache().invalidate(path);
+    return makeFileOperationResult(state, FileSystem::removePath(path), path);
+}
+
+Value GobScriptHelper::nativeTouchFile(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    state.getStatCache().invalidate(path);
+    return makeFileOperationResult(state, FileSystem::touchFile(path), path);
+}
+
+Value GobScriptHelper::nativePrintFile(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    return makeFileOperationResult(state, FileSystem::printFile(path), path);
+}
+
+/// @brief Get optional maximum amount of threads passed after the list of items, 0 means that default should be used
+static size_t getThreadCountArgument(std::vector<Value> const &args, size_t position)
+{
+    if (args.size() <= position)
+    {
+        return 0;
+    }
+    if (args[position].index() != ValueType::Integer || getValueAsInt(args[position]) <= 0)
+    {
+        throw RuntimeActionExecutionError("Expected positive integer for maximum amount of threads");
+    }
+    return getValueAsInt(args[position]);
+}
+
+/// @brief Run file operation on every pair of source and target paths using several threads
+/// @param operation Operation to run, called from different threads
+/// @return Array of results in the same order as the pairs
+static Value runBatchFileOperation(State &state,
+                                   std::vector<Value> const &args,
+                                   std::function<std::error_code(std::filesystem::path const &, std::filesystem::path const &)> const &operation)
+{
+    if (args.empty() || args.size() > 2 || args[0].index() != ValueType::Array)
+    {
+        throw RuntimeActionExecutionError("Expected array of source and target path pairs");
+    }
+    // script values can't be touched from other threads, so paths are copied out first
+    ArrayNode const *pairs = getValueAsArray(args[0]);
+    std::vector<std::pair<std::string, std::string>> paths;
+    for (size_t i = 0; i < pairs->getLen(); i++)
+    {
+        Value pair = pairs->getValueAt(i).value();
+        if (pair.index() != ValueType::Array || getValueAsArray(pair)->getLen() != 2)
+        {
+            throw RuntimeActionExecutionError("Expected pair of source and target paths at " + std::to_string(i));
+        }
+        paths.emplace_back(getPathArgument(getValueAsArray(pair)->getValueAt(0).value()), getPathArgument(getValueAsArray(pair)->getValueAt(1).value()));
+    }
+    // batches touch too many paths to invalidate them one by one
+    state.getStatCache().clear();
+    std::vector<std::error_code> errors(paths.size());
+    GobScriptHelper::Parallel::forEachIndex(
+        paths.size(), [&](size_t i)
+        { errors[i] = operation(paths[i].first, paths[i].second); },
+        getThreadCountArgument(args, 1));
+    std::vector<Value> results;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        results.push_back(makeFileOperationResult(state, errors[i], paths[i].first));
+    }
+    return state.createArray(results);
+}
+
+Value GobScriptHelper::nativeCopyFiles(State &state, std::vector<Value> const &args)
+{
+    return runBatchFileOperation(state, args, FileSystem::copyPath);
+}
+
+Value GobScriptHelper::nativeMoveFiles(State &state, std::vector<Value> const &args)
+{
+    return runBatchFileOperation(state, args, FileSystem::movePath);
+}
+
+Value GobScriptHelper::nativeRemovePaths(State &state, std::vector<Value> const &args)
+{
+    if (args.empty() || args.size() > 2 || args[0].index() != ValueType::Array)
+    {
+        throw RuntimeActionExecutionError("Expected array of paths");
+    }
+    ArrayNode const *items = getValueAsArray(args[0]);
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < items->getLen(); i++)
+    {
+        paths.push_back(getPathArgument(items->getValueAt(i).value()));
+    }
+    state.getStatCache().clear();
+    std::vector<std::error_code> errors(paths.size());
+    Parallel::forEachIndex(
+        paths.size(), [&](size_t i)
+        { errors[i] = FileSystem::removePath(paths[i]); },
+        getThreadCountArgument(args, 1));
+    std::vector<Value> results;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        results.push_back(makeFileOperationResult(state, errors[i], paths[i]));
+    }
+    return state.createArray(results);
+}
+
+Value GobScriptHelper::nativeWalkDirectory(State &state, std::vector<Value> const &args)
+{
+    if (args.empty() || args.size() > 3)
+    {
+        throw RuntimeActionExecutionError("Expected directory path, optional depth and optional entry types");
+    }
+    std::string root = getPathArgument(args[0]);
+    int64_t maxDepth = -1;
+    if (args.size() > 1)
+    {
+        if (args[1].index() != ValueType::Integer)
+        {
+            throw RuntimeActionExecutionError("Expected integer for maximum depth");
+        }
+        maxDepth = getValueAsInt(args[1]);
+    }
+    uint8_t types = FileSystem::EntryType::AnyEntry;
+    if (args.size() > 2)
+    {
+        types = 0;
+        for (char type : convertValueToString(args[2]))
+        {
+            switch (type)
+            {
+            case 'f':
+                types |= FileSystem::EntryType::File;
+                break;
+            case 'd':
+                types |= FileSystem::EntryType::Directory;
+                break;
+            case 'l':
+                types |= FileSystem::EntryType::Symlink;
+                break;
+            case 'o':
+                types |= FileSystem::EntryType::Other;
+                break;
+            default:
+                throw RuntimeActionExecutionError(std::string("Unknown entry type '") + type + "', expected any of 'f', 'd', 'l' or 'o'");
+            }
+        }
+    }
+    std::vector<Value> entries;
+    for (FileSystem::DirectoryEntry &entry : FileSystem::walkDirectory(root, maxDepth, types))
+    {
+        const char *typeName = entry.type == FileSystem::EntryType::File        ? "file"
+                               : entry.type == FileSystem::EntryType::Directory ? "dir"
+                               : entry.type == FileSystem::EntryType::Symlink   ? "link"
+                                                                                : "other";
+        entries.push_back(state.createArray({state.createString(std::move(entry.path)), state.createString(typeName)}));
+    }
+    return state.createArray(entries);
+}
+
+Value GobScriptHelper::nativeStatCache(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected time in milliseconds");
+    }
+    IntegerType timeToLive = getValueAsInt(args[0]);
+    if (timeToLive == 0)
+    {
+        state.getStatCache().disable();
+    }
+    else if (timeToLive < 0)
+    {
+        state.getStatCache().enable({});
+    }
+    else
+    {
+        state.getStatCache().enable(std::chrono::milliseconds(timeToLive));
+    }
+    return Value(0);
+}
+
+Value GobScriptHelper::nativeStatInvalidate(State &state, std::vector<Value> const &args)
+{
+    if (args.empty())
+    {
+        state.getStatCache().clear();
+    }
+    for (Value const &arg : args)
+    {
+        state.getStatCache().invalidate(getPathArgument(arg));
+    }
+    return Value(0);
+}
+
+Value GobScriptHelper::nativeStat(State &state, std::vector<Value> const &args)
+{
+    Pigeon::FileStatus status = state.getStatCache().getStatus(getPathArgument(args[0]));
+    if (status.type == Pigeon::FileType::None)
+    {
+        return Value(0);
+    }
+    const char *typeName = status.type == Pigeon::FileType::File        ? "file"
+                           : status.type == Pigeon::FileType::Directory ? "dir"
+                                                                        : "other";
+    return state.createArray({state.createString(typeName), (IntegerType)status.size, (IntegerType)status.modificationTime});
+}
+
+Value GobScriptHelper::nativeLazy(State &state, std::vector<Value> const &args)
+{
+    return getSequenceArgument(state, args[0]);
+}
+
+Value GobScriptHelper::nativeIterateDirectory(State &state, std::vector<Value> const &args)
+{
+    Value path = args[0];
+    if (path.index() != ValueType::String)
+    {
+        throw RuntimeActionExecutionError("Expected folder path");
+    }
+    if (state.getStatCache().getStatus(std::string(getValueAsString(path)->getView())).type != Pigeon::FileType::Directory)
+    {
+        return Value(0);
+    }
+    return state.createSequence(SequenceSourceType::Directory, std::string(getValueAsString(path)->getView()));
+}
+
+Value GobScriptHelper::nativeTake(State &state, std::vector<Value> const &args)
+{
+    if (args[1].index() != ValueType::Integer || getValueAsInt(args[1]) < 0)
+    {
+        throw RuntimeActionExecutionError("Expected amount of elements to take");
+    }
+    SequenceNode const *sequence = getSequenceArgument(state, args[0]);
+    return state.createSequence(*sequence, SequenceStage{.type = SequenceStageType::Take, .limit = (size_t)getValueAsInt(args[1])});
+}
+
+Value GobScriptHelper::nativeForce(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() == ValueType::Array)
+    {
+        return args[0];
+    }
+    if (args[0].index() != ValueType::Sequence)
+    {
+        throw RuntimeActionExecutionError("Expected array or sequence");
+    }
+    ArrayNode *result = state.createArray({});
+    // stages can call user functions which collect garbage on return
+    result->increaseRefCount();
+    try
+    {
+        iterateSequence(state, getValueAsSequence(args[0]), [result](Value element)
+                        { result->pushBack(element);
+                          return true; });
+    }
+    catch (...)
+    {
+        result->decreaseRefCount();
+        throw;
+    }
+    result->decreaseRefCount();
+    return result;
+}
+
+Value GobScriptHelper::nativeEach(State &state, std::vector<Value> const &args)
+{
+    if (args[1].index() != ValueType::FunctionRef)
+    {
+        throw RuntimeActionExecutionError("Expected callback function");
+    }
+    std::optional<ScriptFunction> func = getCallableFunction(state, getValueAsFunction(args[1]).id, getValueAsFunction(args[1]).native);
+    if (!func.has_value())
+    {
+        throw RuntimeActionExecutionError("Referenced function not found");
+    }
+    SequenceNode *sequence = getSequenceArgument(state, args[0]);
+    // sequence created here from an array isn't referenced by anything else
+    sequence->increaseRefCount();
+    int64_t count = 0;
+    try
+    {
+        iterateSequence(state, sequence, [&](Value element)
+                        {
+                            count++;
+                            Value result = callScriptFunction(state, func.value(), {element});
+                            return result.index() != ValueType::Integer || getValueAsInt(result) != StopIterationValue; });
+    }
+    catch (...)
+    {
+        sequence->decreaseRefCount();
+        throw;
+    }
+    sequence->decreaseRefCount();
+    return Value(count);
+}
+
+Value GobScriptHelper::nativeReadFile(State &state, std::vector<Value> const &args)
+{
+    std::error_code error;
+    std::optional<std::string> contents = Pigeon::readFile(getPathArgument(args[0]), error);
+    if (!contents.has_value())
+    {
+        return Value(0);
+    }
+    return state.createString(std::move(contents.value()));
+}
+
+Value GobScriptHelper::nativeFileLines(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    if (state.getStatCache().getStatus(path).type != Pigeon::FileType::File)
+    {
+        return Value(0);
+    }
+    return state.createSequence(SequenceSourceType::FileLines, path);
+}
+
+Value GobScriptHelper::nativeFileOpen(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    int64_t handle = state.getFileWriters().open(path, false);
+    state.getStatCache().invalidate(path);
+    return (IntegerType)handle;
+}
+
+Value GobScriptHelper::nativeFileAppend(State &state, std::vector<Value> const &args)
+{
+    std::string path = getPathArgument(args[0]);
+    int64_t handle = state.getFileWriters().open(path, true);
+    state.getStatCache().invalidate(path);
+    return (IntegerType)handle;
+}
+
+/// @brief Get handle of the file opened for writing from the argument
+static int64_t getFileHandleArgument(Value const &arg)
+{
+    if (arg.index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected file handle");
+    }
+    return getValueAsInt(arg);
+}
+
+Value GobScriptHelper::nativeFileWrite(State &state, std::vector<Value> const &args)
+{
+    if (args.empty())
+    {
+        throw RuntimeActionExecutionError("Expected file handle");
+    }
+    int64_t handle = getFileHandleArgument(args[0]);
+    bool success = true;
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        // strings are written directly from their storage instead of being copied first
+        if (args[i].index() == ValueType::String)
+        {
+            success = state.getFileWriters().write(handle, getValueAsString(args[i])->getView()) && success;
+        }
+        else
+        {
+            success = state.getFileWriters().write(handle, convertValueToString(args[i])) && success;
+        }
+    }
+    return (IntegerType)(success ? 0 : -1);
+}
+
+Value GobScriptHelper::nativeFileFlush(State &state, std::vector<Value> const &args)
+{
+    int64_t handle = getFileHandleArgument(args[0]);
+    bool success = state.getFileWriters().flush(handle);
+    state.getStatCache().invalidate(state.getFileWriters().getPath(handle));
+    return (IntegerType)(success ? 0 : -1);
+}
+
+Value GobScriptHelper::nativeFileClose(State &state, std::vector<Value> const &args)
+{
+    int64_t handle = getFileHandleArgument(args[0]);
+    std::string path = state.getFileWriters().getPath(handle);
+    bool success = state.getFileWriters().close(handle);
+    state.getStatCache().invalidate(path);
+    return (IntegerType)(success ? 0 : -1);
+}
+
+Value GobScriptHelper::nativeChannel(State &state, std::vector<Value> const &args)
+{
+    return (IntegerType)state.getChannels().create();
+}
+
+/// @brief Get channel from the argument containing its handle
+static std::shared_ptr<Pigeon::Channel> getChannelArgument(State &state, Value const &arg)
+{
+    if (arg.index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected channel handle");
+    }
+    return state.getChannels().get(getValueAsInt(arg));
+}
+
+Value GobScriptHelper::nativeChannelSend(State &state, std::vector<Value> const &args)
+{
+    return (IntegerType)(getChannelArgument(state, args[0])->send(Pigeon::exportValue(args[1])) ? 0 : -1);
+}
+
+Value GobScriptHelper::nativeChannelReceive(State &state, std::vector<Value> const &args)
+{
+    // channel is kept alive by the pointer while waiting
+    std::shared_ptr<Pigeon::Channel> channel = getChannelArgument(state, args[0]);
+    if (std::optional<Pigeon::SharedValue> value = channel->receive(); value.has_value())
+    {
+        return Pigeon::importValue(state, value.value());
+    }
+    return (IntegerType)-1;
+}
+
+Value GobScriptHelper::nativeChannelClose(State &state, std::vector<Value> const &args)
+{
+    getChannelArgument(state, args[0])->close();
+    return Value(0);
+}
+
+Value GobScriptHelper::nativeIsolate(State &state, std::vector<Value> const &args)
+{
+    if (args.empty() || args[0].index() != ValueType::FunctionRef)
+    {
+        throw RuntimeActionExecutionError("Expected function to run in the isolate");
+    }
+    FunctionReference function = getValueAsFunction(args[0]);
+    if (!getCallableFunction(state, function.id, function.native).has_value())
+    {
+        throw RuntimeActionExecutionError("Referenced function not found");
+    }
+    // arguments are copied here, since memory of this state can't be touched from the other thread
+    std::vector<Pigeon::SharedValue> arguments;
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        arguments.push_back(Pigeon::exportValue(args[i]));
+    }
+    return (IntegerType)state.getIsolateManager().start(State::createIsolatedState(state), [function, arguments = std::move(arguments)](State &isolated)
+                                                        {
+                                                            std::vector<Value> values;
+                                                            for (Pigeon::SharedValue const &argument : arguments)
+                                                            {
+                                                                values.push_back(Pigeon::importValue(isolated, argument));
+                                                            }
+                                                            return callScriptFunction(isolated, getCallableFunction(isolated, function.id, function.native).value(), values); });
+}
+
+Value GobScriptHelper::nativeIsolateJoin(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected isolate handle");
+    }
+    try
+    {
+        return Pigeon::importValue(state, state.getIsolateManager().join(getValueAsInt(args[0])));
+    }
+    catch (ExitRequest const &e)
+    {
+        exitScript(state, e.getCode());
+    }
+}
+
+Value GobScriptHelper::nativeParallelMap(State &state, std::vector<Value> const &args)
+{
+    if (args.size() < 2 || args.size() > 3 || args[0].index() != ValueType::Array)
+    {
+        throw RuntimeActionExecutionError("Expected array");
+    }
+    if (args[1].index() != ValueType::FunctionRef)
+    {
+        throw RuntimeActionExecutionError("Expected callback function");
+    }
+    FunctionReference function = getValueAsFunction(args[1]);
+    if (!getCallableFunction(state, function.id, function.native).has_value())
+    {
+        throw RuntimeActionExecutionError("Referenced function not found");
+    }
+    ArrayNode const *array = getValueAsArray(args[0]);
+    std::vector<Pigeon::SharedValue> items;
+    items.reserve(array->getLen());
+    for (size_t i = 0; i < array->getLen(); i++)
+    {
+        items.push_back(Pigeon::exportValue(array->getValueAt(i).value()));
+    }
+    size_t threadCount = getThreadCountArgument(args, 2);
+    size_t workerCount = std::min(items.size(), threadCount == 0 ? Parallel::getDefaultThreadCount() : threadCount);
+    // states are created here, since reading this state from other threads is not safe
+    std::vector<std::unique_ptr<State>> workers;
+    for (size_t i = 0; i < workerCount; i++)
+    {
+        workers.push_back(State::createIsolatedState(state));
+    }
+    std::vector<Pigeon::SharedValue> results(items.size());
+    std::atomic<size_t> nextItem = 0;
+    std::atomic<bool> failed = false;
+    std::mutex errorMutex;
+    // error of the element with the lowest index, so the same error is reported no matter how elements were split
+    std::optional<std::pair<size_t, std::string>> error;
+    // exit called by the function on a helper thread, which ends the script once all threads have stopped
+    std::optional<int> exitCode;
+    Parallel::forEachIndex(
+        workerCount, [&](size_t worker)
+        {
+            State &isolated = *workers[worker];
+            ScriptFunction func = getCallableFunction(isolated, function.id, function.native).value();
+            size_t processed = 0;
+            for (size_t i = nextItem++; i < items.size() && !failed; i = nextItem++)
+            {
+                try
+                {
+                    results[i] = Pigeon::exportValue(callScriptFunction(isolated, func, {Pigeon::importValue(isolated, items[i])}));
+                }
+                catch (ExitRequest const &e)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    exitCode = e.getCode();
+                    failed = true;
+                }
+                catch (std::exception const &e)
+                {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error.has_value() || error->first > i)
+                    {
+                        error = {i, e.what()};
+                    }
+                    failed = true;
+                }
+                // user functions clean up memory on return, but native ones don't
+                if (++processed % 1024 == 0 && function.native)
+                {
+                    isolated.collectGarbage();
+                }
+            } },
+        workerCount);
+    if (exitCode.has_value())
+    {
+        exitScript(state, exitCode.value());
+    }
+    if (error.has_value())
+    {
+        throw RuntimeActionExecutionError("Function failed for element " + std::to_string(error->first) + ": " + error->second);
+    }
+    std::vector<Value> values;
+    values.reserve(results.size());
+    for (Pigeon::SharedValue const &result : results)
+    {
+        values.push_back(Pigeon::importValue(state, result));
+    }
+    return state.createArray(values);
+}
+
+/// @brief Get the pool that runs tasks of all states, started when the first task is spawned
+static GobScriptHelper::Parallel::WorkStealingPool &getTaskPool()
+{
+    static GobScriptHelper::Parallel::WorkStealingPool pool;
+    return pool;
+}
+
+/// @brief Most task states kept by a thread for later tasks. More are only needed if functions change between spawns
+static constexpr size_t MaxIdleTaskStates = 8;
+
+/// @brief States that finished their task on this thread and can run the next one, so that every task doesn't have to create a state.
+/// Thread can be running several tasks at once, since waiting for a task runs other tasks, and each of them needs its own state
+static thread_local std::vector<std::unique_ptr<State>> IdleTaskStates;
+
+/// @brief Get a state created from the template that isn't used by any other task, reusing one that was released by this thread if possible
+static std::unique_ptr<State> takeTaskState(std::shared_ptr<State const> const &taskTemplate)
+{
+    for (std::vector<std::unique_ptr<State>>::reverse_iterator it = IdleTaskStates.rbegin(); it != IdleTaskStates.rend(); it++)
+    {
+        if ((*it)->getTaskTemplate() == taskTemplate)
+        {
+            std::unique_ptr<State> state = std::move(*it);
+            IdleTaskStates.erase(std::next(it).base());
+            return state;
+        }
+    }
+    return State::createTaskState(taskTemplate);
+}
+
+/// @brief Keep the state for the next task that runs on this thread, unless the finished task left something in it that only destroying the state cleans up
+static void releaseTaskState(std::unique_ptr<State> state)
+{
+    if (!state->resetForTask())
+    {
+        return;
+    }
+    if (IdleTaskStates.size() == MaxIdleTaskStates)
+    {
+        IdleTaskStates.erase(IdleTaskStates.begin());
+    }
+    IdleTaskStates.push_back(std::move(state));
+}
+
+Value GobScriptHelper::nativeSpawn(State &state, std::vector<Value> const &args)
+{
+    if (args.empty() || args[0].index() != ValueType::FunctionRef)
+    {
+        throw RuntimeActionExecutionError("Expected function to run as a task");
+    }
+    FunctionReference function = getValueAsFunction(args[0]);
+    if (!getCallableFunction(state, function.id, function.native).has_value())
+    {
+        throw RuntimeActionExecutionError("Referenced function not found");
+    }
+    std::vector<Pigeon::SharedValue> arguments;
+    for (size_t i = 1; i < args.size(); i++)
+    {
+        arguments.push_back(Pigeon::exportValue(args[i]));
+    }
+    // the template is taken here, since this state can't be read from the thread that will run the task
+    std::shared_ptr<Pigeon::Task> task = std::make_shared<Pigeon::Task>([taskTemplate = state.getTaskTemplate(), function, arguments = std::move(arguments)]()
+                                                                        {
+                                                                            std::unique_ptr<State> isolated = takeTaskState(taskTemplate);
+                                                                            try
+                                                                            {
+                                                                                std::vector<Value> values;
+                                                                                for (Pigeon::SharedValue const &argument : arguments)
+                                                                                {
+                                                                                    values.push_back(Pigeon::importValue(*isolated, argument));
+                                                                                }
+                                                                                Pigeon::SharedValue result = Pigeon::exportValue(callScriptFunction(*isolated, getCallableFunction(*isolated, function.id, function.native).value(), values));
+                                                                                releaseTaskState(std::move(isolated));
+                                                                                return result;
+                                                                            }
+                                                                            catch (...)
+                                                                            {
+                                                                                releaseTaskState(std::move(isolated));
+                                                                                throw;
+                                                                            } });
+    getTaskPool().submit([task]()
+                         { task->run(); });
+    return (IntegerType)state.getTaskManager().add(std::move(task));
+}
+
+Value GobScriptHelper::nativeJoin(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::Integer)
+    {
+        throw RuntimeActionExecutionError("Expected task handle");
+    }
+    std::shared_ptr<Pigeon::Task> task = state.getTaskManager().take(getValueAsInt(args[0]));
+    // the thread keeps running other tasks while waiting, which also lets tasks wait for their own subtasks without running out of threads
+    getTaskPool().waitUntil([&task]()
+                            { return task->isFinished(); });
+    if (task->getExitCode().has_value())
+    {
+        exitScript(state, task->getExitCode().value());
+    }
+    if (task->getError().has_value())
+    {
+        throw RuntimeActionExecutionError("Task failed: " + task->getError().value());
+    }
+    return Pigeon::importValue(state, task->getResult());
+}
+
+Value GobScriptHelper::nativeGlob(State &state, std::vector<Value> const &args)
+{
+    if (args.empty() || args.size() > 2 || args[0].index() != ValueType::String)
+    {
+        throw RuntimeActionExecutionError("Expected pattern and optional maximum amount of threads");
+    }
+    Glob::Pattern pattern(getValueAsString(args[0])->getView());
+    std::vector<Value> paths;
+    for (std::string &path : Glob::findPaths(pattern, getThreadCountArgument(args, 1)))
+    {
+        paths.push_back(state.createString(std::move(path)));
+    }
+    return state.createArray(paths);
+}
+
+/// @brief Get compiled regular expression for the pattern argument and check that the text argument is a string
+static Pigeon::Regex const &getRegexArguments(State &state, std::vector<Value> const &args)
+{
+    if (args[0].index() != ValueType::String)
+    {
+        throw RuntimeActionExecutionError("Expected regular expression pattern");
+    }
+    if (args[1].index() != ValueType::String)
+    {
+        throw RuntimeActionExecutionError("Expected string to match");
+    }
+    return state.getRegexCache().get(std::string(getValueAsString(args[0])->getView()));
+}
+
+/// @brief Create array of the whole match followed by captured groups, groups that didn't take part in the match are empty strings
+static Value createMatchArray(State &state, Pigeon::Regex::Match const &result)
+{
+    std::vector<Value> groups;
+    for (std::string_view group : result)
+    {
+        groups.push_back(state.createString(std::string(group)));
+    }
+    return state.createArray(groups);
+}
+
+Value GobScriptHelper::nativeRegexMatch(State &state, std::vector<Value> const &args)
+{
+    Pigeon::Regex const &regex = getRegexArguments(state, args);
+    Pigeon::Regex::Match result;
+    if (!regex.match(getValueAsString(args[1])->getView(), result))
+    {
+        return 0;
+    }
+    return createMatchArray(state, result);
+}
+
+Value GobScriptHelper::nativeRegexSearch(State &state, std::vector<Value> const &args)
+{
+    Pigeon::Regex const &regex = getRegexArguments(state, args);
+    Pigeon::Regex::Match result;
+    if (!regex.search(getValueAsString(args[1])->getView(), 0, result))
+    {
+        return 0;
+    }
+    return createMatchArray(state, result);
+}
+
+Value GobScriptHelper::nativeRegexReplace(State &state, std::vector<Value> const &args)
+{
+    Pigeon::Regex const &regex = getRegexArguments(state, args);
+    if (args[2].index() != ValueType::String)
+    {
+        throw RuntimeActionExecutionError("Expected replacement string");
+    }
+    std::string_view text = getValueAsString(args[1])->getView();
+    std::string replacement(getValueAsString(args[2])->getView());
+    std::string replaced;
+    Pigeon::Regex::Match result;
+    // end of the text already copied into the result and offset where the next search starts
+    size_t copied = 0;
+    size_t offset = 0;
+    while (offset <= text.size() && regex.search(text, offset, result))
+    {
+        size_t start = result[0].data() - text.data();
+        size_t end = start + result[0].size();
+        replaced.append(text.substr(copied, start - copied));
+        Pigeon::Regex::appendReplacement(text, result, replacement, replaced);
+        copied = end;
+        offset = end;
+        // empty match would be found again at the same place
+        if (start == end)
+        {
+            if (end < text.size())
+            {
+                replaced += text[end];
+            }
+            copied = offset = end + 1;
+        }
+    }
+    if (copied < text.size())
+    {
+        replaced.append(text.substr(copied));
+    }
+    return state.createString(std::move(replaced));
+}
+
+Value GobScriptHelper::nativeRegexSplit(State &state, std::vector<Value> const &args)
+{
+    Pigeon::Regex const &regex = getRegexArguments(state, args);
+    std::string_view text = getValueAsString(args[1])->getView();
+    std::vector<std::string_view> parts;
+    Pigeon::Regex::Match result;
+    size_t copied = 0;
+    size_t offset = 0;
+    while (offset <= text.size() && regex.search(text, offset, result))
+    {
+        size_t start = result[0].data() - text.data();
+        size_t end = start + result[0].size();
+        // empty matches don't split, otherwise every character would become a part
+        if (start == end)
+        {
+            offset = end + 1;
+            continue;
+        }
+        parts.push_back(text.substr(copied, start - copied));
+        copied = offset = end;
+    }
+    parts.push_back(text.substr(copied));
+    std::vector<Value> values;
+    for (std::string_view part : parts)
+    {
+        values.push_back(state.createString(std::string(part)));
+    }
+    return state.createArray(values);
 }
@@ -11,13 +11,6 @@ namespace GobScriptHelper
     /// @brief Abstraction around both Pigeon and c++ functions to help with callbacks
     using ScriptFunction = std::variant<Function, State::NativeFunction>;
 
-    /// @brief Attempt to parse given code string and return a runnable action object
-    /// @param code Code to parse
-    /// @return Smart pointer containing runnable action or nullptr if parsing failed. Exception is thrown on parsing error
-    std::unique_ptr<Action> loadString(std::string const &code);
-
-    std::unique_ptr<Action> loadFile(std::string const &filepath);
-
     /// @brief Attempt to retrieve a function with a given id
     /// @param state State to search the function in
     /// @param id Id of the function
@@ -78,9 +71,332 @@ namespace GobScriptHelper
     /// @return 
     Value nativeConvertCharStringToAsciiInt(State &state, std::vector<Value> const &args);
 
-    /// @brief Ends execution of the program returning the first argument converted to int as the exit code. This function does not return anything and ends entire program execution
+    /// @brief Ends execution of the program returning the first argument converted to int as the exit code. This function does not return anything and ends entire program execution.
+    /// Called by a task, an isolate or a `pmap` callback it stops the function instead, and the program ends once the task or isolate is joined or `pmap` returns
     /// @param state 
     /// @param args 
     /// @return 
     Value nativeExit(State &state, std::vector<Value> const &args);
-}
\ No newline at end of file
+
+    /// @brief Run several commands at once, with at most N commands running at the same time. Output of each command is printed as a whole once it finishes
+    /// @param state
+    /// @param args Array of commands, where each command is an array of program name and arguments, and optional maximum amount of running commands which defaults to the amount of cores
+    /// @return Array of exit codes in the same order as commands
+    Value nativeExecParallel(State &state, std::vector<Value> const &args);
+
+    /// @brief Run commands at the same time with output of each command connected to the input of the next one
+    /// @param state
+    /// @param args Commands, where each command is an array of program name and arguments
+    /// @return Array of exit codes of every command
+    Value nativePipeline(State &state, std::vector<Value> const &args);
+
+    /// @brief Start a command in the background without waiting for it to finish. Output of the command is printed line by line whenever script checks on any background command
+    /// @param state
+    /// @param args Program name followed by arguments
+    /// @return Handle of the process that can be used with `exec_poll` and `exec_wait`
+    Value nativeExecAsync(State &state, std::vector<Value> const &args);
+
+    /// @brief Check if the background command has finished
+    /// @param state
+    /// @param args Handle of the process
+    /// @return Exit code of the process or -1 if it's still running
+    Value nativeExecPoll(State &state, std::vector<Value> const &args);
+
+    /// @brief Wait for background command to finish. Handle can not be used after this
+    /// @param state
+    /// @param args Handle of the process
+    /// @return Exit code of the process
+    Value nativeExecWait(State &state, std::vector<Value> const &args);
+
+    /// @brief Run a command and call a function for each line of its output as soon as the line is read. Memory use doesn't depend on the size of the output
+    /// @param state
+    /// @param args Function to call, program name and arguments. If function returns -1 the command is stopped
+    /// @return Exit code of the command
+    Value nativeExecLines(State &state, std::vector<Value> const &args);
+
+    /// @brief Get statistics of the cache used for finding programs in PATH
+    /// @param state
+    /// @param args
+    /// @return Array containing amount of cache hits, amount of cache misses and amount of remembered programs
+    Value nativeCommandCacheStats(State &state, std::vector<Value> const &args);
+
+    /// @brief Forget all remembered program locations and reset statistics, similar to `hash -r` in shell
+    /// @param state
+    /// @param args
+    /// @return
+    Value nativeClearCommandCache(State &state, std::vector<Value> const &args);
+
+    /// @brief Print totals of time and memory used by every program run so far, programs that took most time come first
+    /// @param state
+    /// @param args
+    /// @return
+    Value nativeCommandReport(State &state, std::vector<Value> const &args);
+
+    /// @brief Run a command in its own process group and stop the whole group if it doesn't finish in time
+    /// @param state
+    /// @param args Time limit in milliseconds, program name and arguments
+    /// @return Exit code of the command or -1 if it was stopped because of the time limit
+    Value nativeExecTimeout(State &state, std::vector<Value> const &args);
+
+    /// @brief Start a helper program that keeps running and exchanges lines with the script through its stdin and stdout
+    /// @param state
+    /// @param args Program name followed by arguments
+    /// @return Handle of the coprocess that can be used with `coproc_write`, `coproc_read` and `coproc_close`
+    Value nativeCoprocessOpen(State &state, std::vector<Value> const &args);
+
+    /// @brief Write a line into stdin of the coprocess
+    /// @param state
+    /// @param args Handle of the coprocess and the line. New line is added at the end if line doesn't have one
+    /// @return 0 on success or -1 if coprocess no longer reads its input
+    Value nativeCoprocessWrite(State &state, std::vector<Value> const &args);
+
+    /// @brief Wait for the next line of the output of the coprocess
+    /// @param state
+    /// @param args Handle of the coprocess
+    /// @return Line without new line character or -1 if coprocess closed its output
+    Value nativeCoprocessRead(State &state, std::vector<Value> const &args);
+
+    /// @brief Close input of the coprocess and wait for it to exit. Handle can not be used after this
+    /// @param state
+    /// @param args Handle of the coprocess
+    /// @return Exit code of the coprocess
+    Value nativeCoprocessClose(State &state, std::vector<Value> const &args);
+
+    /// @brief Create directory and all missing parent directories, same as `mkdir -p`
+    /// @param state
+    /// @param args Path to the directory
+    /// @return 0 on success or string describing the error
+    Value nativeMakeDirectory(State &state, std::vector<Value> const &args);
+
+    /// @brief Copy file or directory with everything inside of it, same as `cp -r`
+    /// @param state
+    /// @param args Path to copy and target path. If target is an existing directory the copy is placed inside of it
+    /// @return 0 on success or string describing the error
+    Value nativeCopyPath(State &state, std::vector<Value> const &args);
+
+    /// @brief Move file or directory, same as `mv`
+    /// @param state
+    /// @param args Path to move and target path. If target is an existing directory the path is moved inside of it
+    /// @return 0 on success or string describing the error
+    Value nativeMovePath(State &state, std::vector<Value> const &args);
+
+    /// @brief Remove file or directory with everything inside of it, same as `rm -r`
+    /// @param state
+    /// @param args Path to remove
+    /// @return 0 on success or string describing the error
+    Value nativeRemovePath(State &state, std::vector<Value> const &args);
+
+    /// @brief Create empty file or update modification time of the existing one, same as `touch`
+    /// @param state
+    /// @param args Path to the file
+    /// @return 0 on success or string describing the error
+    Value nativeTouchFile(State &state, std::vector<Value> const &args);
+
+    /// @brief Print contents of the file, same as `cat`
+    /// @param state
+    /// @param args Path to the file
+    /// @return 0 on success or string describing the error
+    Value nativePrintFile(State &state, std::vector<Value> const &args);
+
+    /// @brief Copy many files or directories at once using several threads, each item is copied same as with `copy_path`
+    /// @param state
+    /// @param args Array of pairs of source and target paths and optional maximum amount of threads which defaults to the amount of cores
+    /// @return Array with 0 or error string for every pair in the same order
+    Value nativeCopyFiles(State &state, std::vector<Value> const &args);
+
+    /// @brief Move many files or directories at once using several threads, each item is moved same as with `move_path`
+    /// @param state
+    /// @param args Array of pairs of source and target paths and optional maximum amount of threads which defaults to the amount of cores
+    /// @return Array with 0 or error string for every pair in the same order
+    Value nativeMoveFiles(State &state, std::vector<Value> const &args);
+
+    /// @brief Remove many files or directories at once using several threads, each item is removed same as with `remove_path`
+    /// @param state
+    /// @param args Array of paths and optional maximum amount of threads which defaults to the amount of cores
+    /// @return Array with 0 or error string for every path in the same order
+    Value nativeRemovePaths(State &state, std::vector<Value> const &args);
+
+    /// @brief Recursively list everything inside of the directory using several threads
+    /// @param state
+    /// @param args Path to the directory, optional maximum depth where 1 means only direct children and -1 means no limit,
+    /// and optional string of entry types to return: 'f' for files, 'd' for directories, 'l' for symbolic links and 'o' for everything else
+    /// @return Array of pairs of path and type, which is one of "file", "dir", "link" or "other", sorted by path
+    Value nativeWalkDirectory(State &state, std::vector<Value> const &args);
+
+    /// @brief Enable or disable cache of file metadata used by `stat`, `is_dir`, `is_file` and `listdir`
+    /// @param state
+    /// @param args How long metadata is remembered in milliseconds, -1 to remember it until it's invalidated and 0 to disable the cache
+    /// @return
+    Value nativeStatCache(State &state, std::vector<Value> const &args);
+
+    /// @brief Forget remembered metadata of the paths and everything inside of them, or of all paths if no paths are given
+    /// @param state
+    /// @param args Paths to forget
+    /// @return
+    Value nativeStatInvalidate(State &state, std::vector<Value> const &args);
+
+    /// @brief Get type, size and modification time of the file in one call
+    /// @param state
+    /// @param args Path to the file
+    /// @return Array of type ("file", "dir" or "other"), size in bytes and modification time in seconds since unix epoch, or 0 if path doesn't exist
+    Value nativeStat(State &state, std::vector<Value> const &args);
+
+    /// @brief Create a lazy sequence that goes over elements of the array. `map`, `filter` and `take` called with a sequence
+    /// don't run anything and instead return a new sequence with one more stage
+    /// @param state
+    /// @param args Array or sequence
+    /// @return Sequence
+    Value nativeLazy(State &state, std::vector<Value> const &args);
+
+    /// @brief Create a lazy sequence of paths of entries in the directory, which is only read while the sequence is iterated
+    /// @param state
+    /// @param args Path to the directory
+    /// @return Sequence or 0 if path is not a directory
+    Value nativeIterateDirectory(State &state, std::vector<Value> const &args);
+
+    /// @brief Limit the amount of elements of the sequence. Elements after the limit are never produced
+    /// @param state
+    /// @param args Array or sequence and the maximum amount of elements
+    /// @return Sequence
+    Value nativeTake(State &state, std::vector<Value> const &args);
+
+    /// @brief Run all stages of the sequence and collect the results
+    /// @param state
+    /// @param args Sequence or array, which is returned as is
+    /// @return Array with all elements of the sequence
+    Value nativeForce(State &state, std::vector<Value> const &args);
+
+    /// @brief Call a function with every element of the sequence or array without collecting them.
+    /// Returning -1 from the function stops the iteration
+    /// @param state
+    /// @param args Sequence or array and the function
+    /// @return Amount of elements the function was called with
+    Value nativeEach(State &state, std::vector<Value> const &args);
+
+    /// @brief Read contents of the file into a string that owns them, so that changes made to the file later don't affect the string
+    /// @param state
+    /// @param args Path to the file
+    /// @return String with contents of the file or 0 if file can't be read
+    Value nativeReadFile(State &state, std::vector<Value> const &args);
+
+    /// @brief Create a lazy sequence of lines of the file without line breaks. File is read through a fixed size buffer as lines are needed
+    /// @param state
+    /// @param args Path to the file
+    /// @return Sequence or 0 if path is not a file
+    Value nativeFileLines(State &state, std::vector<Value> const &args);
+
+    /// @brief Open the file for writing, replacing its contents. Written data is collected in a large buffer before being written into the file
+    /// @param state
+    /// @param args Path to the file
+    /// @return Handle used by `file_write`, `file_flush` and `file_close`
+    Value nativeFileOpen(State &state, std::vector<Value> const &args);
+
+    /// @brief Open the file for writing at the end of its existing contents
+    /// @param state
+    /// @param args Path to the file
+    /// @return Handle used by `file_write`, `file_flush` and `file_close`
+    Value nativeFileAppend(State &state, std::vector<Value> const &args);
+
+    /// @brief Write values into the file one after another without any separators
+    /// @param state
+    /// @param args Handle of the file and values to write
+    /// @return 0 on success or -1 if data could not be written
+    Value nativeFileWrite(State &state, std::vector<Value> const &args);
+
+    /// @brief Write everything that was buffered into the file
+    /// @param state
+    /// @param args Handle of the file
+    /// @return 0 on success or -1 if data could not be written
+    Value nativeFileFlush(State &state, std::vector<Value> const &args);
+
+    /// @brief Write everything that was buffered and close the file. Files that are not closed are closed once the script ends
+    /// @param state
+    /// @param args Handle of the file
+    /// @return 0 on success or -1 if any of the data could not be written
+    Value nativeFileClose(State &state, std::vector<Value> const &args);
+
+    /// @brief Create a channel that can be used to send values between the script and isolates started by it
+    /// @param state
+    /// @param args
+    /// @return Handle of the channel
+    Value nativeChannel(State &state, std::vector<Value> const &args);
+
+    /// @brief Send a copy of the value through the channel
+    /// @param state
+    /// @param args Handle of the channel and the value
+    /// @return 0 on success or -1 if channel was closed
+    Value nativeChannelSend(State &state, std::vector<Value> const &args);
+
+    /// @brief Wait until there is a value in the channel and take it
+    /// @param state
+    /// @param args Handle of the channel
+    /// @return Value or -1 if channel was closed and all values were received
+    Value nativeChannelReceive(State &state, std::vector<Value> const &args);
+
+    /// @brief Stop the channel from accepting new values. Values sent before that can still be received
+    /// @param state
+    /// @param args Handle of the channel
+    /// @return
+    Value nativeChannelClose(State &state, std::vector<Value> const &args);
+
+    /// @brief Call the function on a new thread in an isolate, which has its own memory and variables but shares functions and channels with the script
+    /// @param state
+    /// @param args Function and its arguments, which are copied into the isolate
+    /// @return Handle of the isolate
+    Value nativeIsolate(State &state, std::vector<Value> const &args);
+
+    /// @brief Wait for the isolate to finish
+    /// @param state
+    /// @param args Handle of the isolate
+    /// @return Copy of the value returned by the function
+    Value nativeIsolateJoin(State &state, std::vector<Value> const &args);
+
+    /// @brief Call the function for every element of the array using several threads, each running its own isolate.
+    /// Elements are copied into isolates and results are copied back
+    /// @param state
+    /// @param args Array, function and optional maximum amount of threads which defaults to the amount of cores
+    /// @return Array of results in the same order as the elements
+    Value nativeParallelMap(State &state, std::vector<Value> const &args);
+
+    /// @brief Call the function as a task on the shared pool of threads. Task runs in its own isolate, arguments are copied into it
+    /// @param state
+    /// @param args Function and arguments that will be passed to it
+    /// @return Handle of the task
+    Value nativeSpawn(State &state, std::vector<Value> const &args);
+
+    /// @brief Wait for the task spawned by this state to finish, running other tasks in the meantime
+    /// @param state
+    /// @param args Handle of the task
+    /// @return Copy of the value returned by the function
+    Value nativeJoin(State &state, std::vector<Value> const &args);
+
+    /// @brief Find paths that match the pattern, reading only directories that can contain matches
+    /// @param state
+    /// @param args Pattern with `*`, `?`, `**`, character classes and brace sets, and optional maximum amount of threads
+    /// @return Array of matching paths sorted
+    Value nativeGlob(State &state, std::vector<Value> const &args);
+
+    /// @brief Check if the whole string matches the regular expression
+    /// @param state
+    /// @param args Pattern and string
+    /// @return Array with the matched string followed by captured groups, or 0 if string doesn't match
+    Value nativeRegexMatch(State &state, std::vector<Value> const &args);
+
+    /// @brief Find the first part of the string that matches the regular expression
+    /// @param state
+    /// @param args Pattern and string
+    /// @return Array with the matched part followed by captured groups, or 0 if nothing matches
+    Value nativeRegexSearch(State &state, std::vector<Value> const &args);
+
+    /// @brief Replace every part of the string that matches the regular expression
+    /// @param state
+    /// @param args Pattern, string and replacement, which can refer to the match with `$&` and to groups with `$1`, `$2` and so on
+    /// @return New string with replacements
+    Value nativeRegexReplace(State &state, std::vector<Value> const &args);
+
+    /// @brief Split the string at every part that matches the regular expression
+    /// @param state
+    /// @param args Pattern and string
+    /// @return Array of parts between the matches
+    Value nativeRegexSplit(State &state, std::vector<Value> const &args);
+}
@@ -3,11 +3,14 @@
 #include "Function.hpp"
 
 #include "StandardFunctions.hpp"
+#include "Parser.hpp"
 
 #if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
-#include <unistd.h>    /* for fork */
-#include <sys/types.h> /* for pid_t */
-#include <sys/wait.h>  /* for wait */
+#include <unistd.h>    /* for pipe */
+#include <fcntl.h>     /* for O_CLOEXEC */
+#include <cstring>     /* for strerror */
+#include <cerrno>
+#include "Process.hpp"
 #elif (defined(_WIN32) || defined(_WIN64))
 #include <Windows.h>
 #include <locale>
@@ -99,7 +102,9 @@ Value BinaryOperationAction::execute(State &state) const
 
     if (a.index() == ValueType::String && b.index() == ValueType::String && m_op == Operator::Add)
     {
-        return state.createString(getValueAsString(a)->getValue() + getValueAsString(b)->getValue());
+        std::string result(getValueAsString(a)->getView());
+        result += getValueAsString(b)->getView();
+        return state.createString(std::move(result));
     }
     if (a.index() != b.index() || a.index() != ValueType::Integer)
     {
@@ -178,6 +183,20 @@ Value BinaryOperationAction::execute(State &state) const
     return a;
 }
 
+Value CommandCallAction::makeCommandResult(State &state, Pigeon::Process::ProcessResult const &result) const
+{
+    if (m_mode != CommandOutputMode::Measure)
+    {
+        return Value((IntegerType)result.exitCode);
+    }
+    return state.createArray({(IntegerType)result.exitCode,
+                              (IntegerType)result.signal,
+                              (IntegerType)result.wallTime.count(),
+                              (IntegerType)result.userTime.count(),
+                              (IntegerType)result.systemTime.count(),
+                              (IntegerType)result.maxResidentKb});
+}
+
 Value CommandCallAction::execute(State &state) const
 {
     std::string programName = convertValueToString(m_commandName->execute(state));
@@ -188,40 +207,88 @@ Value CommandCallAction::execute(State &state) const
     {
         argsV.push_back(convertValueToString(arg->execute(state)));
     }
-    std::vector<const char *> args = {programName.c_str()};
-    for (std::string const &arg : argsV)
+    Pigeon::Process::SpawnOptions options;
+    options.errorToOutput = m_mergeErrorOutput;
+    options.pathCache = &state.getCommandPathCache();
+    for (CommandRedirection const &redirection : m_redirections)
     {
-        args.push_back(arg.c_str());
+        std::string path = convertValueToString(redirection.target->execute(state));
+        switch (redirection.type)
+        {
+        case CommandRedirectionType::Input:
+            options.files.push_back({.fd = STDIN_FILENO, .path = path, .flags = O_RDONLY});
+            break;
+        case CommandRedirectionType::Output:
+            options.files.push_back({.fd = STDOUT_FILENO, .path = path, .flags = O_WRONLY | O_CREAT | O_TRUNC});
+            break;
+        case CommandRedirectionType::OutputAppend:
+            options.files.push_back({.fd = STDOUT_FILENO, .path = path, .flags = O_WRONLY | O_CREAT | O_APPEND});
+            break;
+        case CommandRedirectionType::ErrorOutput:
+            options.files.push_back({.fd = STDERR_FILENO, .path = path, .flags = O_WRONLY | O_CREAT | O_TRUNC});
+            break;
+        case CommandRedirectionType::ErrorOutputAppend:
+            options.files.push_back({.fd = STDERR_FILENO, .path = path, .flags = O_WRONLY | O_CREAT | O_APPEND});
+            break;
+        }
     }
-    args.push_back(nullptr);
+    // pipe is created after redirection targets are evaluated, so that an error in them doesn't leave it open
     int pipefd[2];
-    pipe(pipefd);
-    pid_t pid = fork();
-    if (pid == 0)
+    if (pipe2(pipefd, O_CLOEXEC) == -1)
     {
-        close(pipefd[0]);
-        dup2(pipefd[1], 1);
-        dup2(pipefd[1], 2);
-        close(pipefd[1]);
-        execvp(programName.c_str(), (char *const *)args.data());
-        exit(127);
+        throwRuntimeError(getCodePosition(), std::string("Failed to create pipe: ") + strerror(errno));
+    }
+    options.stdoutFd = pipefd[1];
+    if (m_mode != CommandOutputMode::Capture && !m_mergeErrorOutput)
+    {
+        options.stderrFd = pipefd[1];
     }
-    else
+    Pigeon::Process::ProcessId pid;
+    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+    try
     {
-        char buffer[1024];
-        memset(buffer, 0, sizeof(buffer));
+        pid = Pigeon::Process::spawnProcess(programName, argsV, options);
+    }
+    catch (RuntimeActionExecutionError const &e)
+    {
+        close(pipefd[0]);
         close(pipefd[1]);
-        while (read(pipefd[0], buffer, sizeof(buffer)) != 0)
+        std::cerr << e.what() << std::endl;
+        if (m_mode == CommandOutputMode::Capture)
         {
-            std::cout << buffer << std::endl;
-            memset(buffer, 0, sizeof(buffer));
+            return state.createString("");
         }
-        int status;
-        waitpid(pid, &status, 0);
-        return Value(status);
+        return makeCommandResult(state, Pigeon::Process::getSpawnFailureResult());
     }
+    close(pipefd[1]);
+    if (m_mode == CommandOutputMode::Capture)
+    {
+        std::string output = Pigeon::Process::readOutput(pipefd[0]);
+        close(pipefd[0]);
+        state.getCommandStatistics().record(programName, Pigeon::Process::waitForProcess(pid, startTime));
+        // same as shell command substitution, trailing new lines are almost never wanted
+        while (!output.empty() && output.back() == '\n')
+        {
+            output.pop_back();
+        }
+        return state.createString(std::move(output));
+    }
+    // anything printed by the script so far has to appear before the output of the child
+    std::cout.flush();
+    Pigeon::Process::forwardOutput(pipefd[0], STDOUT_FILENO);
+    close(pipefd[0]);
+    Pigeon::Process::ProcessResult result = Pigeon::Process::waitForProcess(pid, startTime);
+    state.getCommandStatistics().record(programName, result);
+    return makeCommandResult(state, result);
 #elif (defined(_WIN32) || defined(_WIN64))
-
+    if (m_mode != CommandOutputMode::Print)
+    {
+        throwRuntimeError(getCodePosition(), "Capturing command output or resource usage is not implemented for this platform");
+    }
+    if (!m_redirections.empty())
+    {
+        throwRuntimeError(getCodePosition(), "Redirecting command streams is not implemented for this platform");
+    }
 
     std::string cmd = programName + " ";
     for (std::unique_ptr<Action> const &arg : m_arguments)
@@ -409,6 +476,21 @@ Value FunctionDeclarationAction::execute(State &state) const
     return Value(FunctionReference{.id = (uint32_t)state.getUserFunctionIdByName(m_name).value(), .native = false});
 }
 
+Value LazyFunctionBodyAction::execute(State &state) const
+{
+    // if parsing fails the flag is not set, so every call reports the error
+    std::call_once(m_parsed, [this]()
+                   {
+        std::string::const_iterator it = getCodePosition();
+        std::unique_ptr<Action> body = Pigeon::Parser::parseFunction(it, m_end);
+        if (body == nullptr)
+        {
+            throwParsingError(it, "Expected function body");
+        }
+        m_body = std::move(body); });
+    return m_body->execute(state);
+}
+
 Value FunctionCallAction::execute(State &state) const
 {
     Value funcId = m_functionAccess->execute(state);
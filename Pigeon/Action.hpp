@@ -3,6 +3,7 @@
 #include <memory>
 #include <vector>
 #include <map>
+#include <mutex>
 
 #include <string.h>
 
@@ -178,22 +179,69 @@ private:
     std::map<std::string, std::unique_ptr<Action>> m_variables;
 };
 
+/// @brief What should happen to the output of the command called with `exec` family of actions
+enum class CommandOutputMode
+{
+    /// @brief Output is printed into interpreter output and status of the command is returned
+    Print,
+    /// @brief Output is returned as a string
+    Capture,
+    /// @brief Output is printed into interpreter output and record with exit code and resource usage of the command is returned
+    Measure,
+};
+
+/// @brief Kinds of redirection of the standard streams that can be written among `exec` arguments
+enum class CommandRedirectionType
+{
+    /// @brief `<`, read stdin from the file
+    Input,
+    /// @brief `>`, write stdout into the file replacing its contents
+    Output,
+    /// @brief `>>`, append stdout to the end of the file
+    OutputAppend,
+    /// @brief `2>`, write stderr into the file replacing its contents
+    ErrorOutput,
+    /// @brief `2>>`, append stderr to the end of the file
+    ErrorOutputAppend,
+};
+
+struct CommandRedirection
+{
+    CommandRedirectionType type;
+    /// @brief Action that returns path to the file
+    std::unique_ptr<Action> target;
+};
+
 class CommandCallAction : public Action
 {
 public:
     explicit CommandCallAction(std::string::const_iterator const &it,
                                std::unique_ptr<Action> commandName,
-                               std::vector<std::unique_ptr<Action>> arguments) : m_commandName(std::move(commandName)),
-                                                                                 m_arguments(std::move(arguments)),
-                                                                                 Action(it) {}
-
-    explicit CommandCallAction(std::string::const_iterator const &it, std::unique_ptr<Action> commandName) : m_commandName(std::move(commandName)), Action(it) {}
+                               std::vector<std::unique_ptr<Action>> arguments,
+                               CommandOutputMode mode = CommandOutputMode::Print,
+                               bool mergeErrorOutput = false,
+                               std::vector<CommandRedirection> redirections = {}) : Action(it),
+                                                                                    m_commandName(std::move(commandName)),
+                                                                                    m_arguments(std::move(arguments)),
+                                                                                    m_mode(mode),
+                                                                                    m_mergeErrorOutput(mergeErrorOutput),
+                                                                                    m_redirections(std::move(redirections)) {}
+
+    explicit CommandCallAction(std::string::const_iterator const &it, std::unique_ptr<Action> commandName) : Action(it), m_commandName(std::move(commandName)) {}
 
     Value execute(State &state) const override;
 
 private:
+    /// @brief Convert result of the finished command into the value returned by the action, which is either exit code or a record depending on the mode
+    Value makeCommandResult(State &state, Pigeon::Process::ProcessResult const &result) const;
+
     std::unique_ptr<Action> m_commandName;
     std::vector<std::unique_ptr<Action>> m_arguments;
+    CommandOutputMode m_mode = CommandOutputMode::Print;
+    /// @brief Should stderr of the command be captured together with stdout. Printed output always contains both
+    bool m_mergeErrorOutput = false;
+    /// @brief Files that are opened by the command in place of standard streams, data written there never goes through the interpreter
+    std::vector<CommandRedirection> m_redirections;
 };
 
 class CreateArrayAction : public Action
@@ -222,6 +270,24 @@ private:
     std::vector<std::string> m_arguments;
 };
 
+/// @brief Function body that was only checked for bracket structure during parsing. Actual parsing happens on the first execution
+class LazyFunctionBodyAction : public Action
+{
+public:
+    /// @brief Create lazy body for the code in range [it, end)
+    /// @param it Position of the opening bracket of the body
+    /// @param end Position right after the closing bracket of the body
+    explicit LazyFunctionBodyAction(std::string::const_iterator const &it, std::string::const_iterator const &end) : Action(it), m_end(end) {}
+    Value execute(State &state) const override;
+
+private:
+    std::string::const_iterator m_end;
+    /// @brief Parsed body, remains null until the function is called for the first time
+    mutable std::unique_ptr<Action> m_body;
+    /// @brief Makes sure body is parsed only once, even if the function is first called by several isolates at the same time
+    mutable std::once_flag m_parsed;
+};
+
 class FunctionCallAction : public Action
 {
 public:
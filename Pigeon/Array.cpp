@@ -1,4 +1,5 @@
 #include "Array.hpp"
+#include "Sequence.hpp"
 
 ArrayNode::ArrayNode(std::vector<Value> const &values) : m_values(values)
 {
@@ -78,5 +79,9 @@ ArrayNode::~ArrayNode()
         {
             std::get<StringNode *>(m_values[i])->decreaseRefCount();
         }
+        else if (m_values[i].index() == ValueType::Sequence)
+        {
+            std::get<SequenceNode *>(m_values[i])->decreaseRefCount();
+        }
     }
 }
@@ -36,3 +36,12 @@ const char *RuntimeError::what() const throw()
 RuntimeError::RuntimeError(std::string::const_iterator const &pos, std::string const &msg) : m_it(pos), m_message(msg)
 {
 }
+
+const char *ExitRequest::what() const throw()
+{
+    return m_message.c_str();
+}
+
+ExitRequest::ExitRequest(int code) : m_code(code), m_message("Exit with code " + std::to_string(code) + " was requested")
+{
+}
@@ -38,6 +38,20 @@ private:
     std::string m_message;
 };
 
+/// @brief Thrown by `exit` when it's called on a thread that can't end the process, such as by a task, and carried to whoever joins the task
+class ExitRequest : public std::exception
+{
+public:
+    const char *what() const throw() override;
+    explicit ExitRequest(int code);
+
+    int getCode() const { return m_code; }
+
+private:
+    int m_code;
+    std::string m_message;
+};
+
 /// @brief Throw general purpose error with given message. Wrapper around whatever error handling system the project uses
 /// @param errorMessage Message to display
 void throwRuntimeError(std::string::const_iterator const &pos, std::string const &errorMessage);
@@ -0,0 +1,136 @@
+#include "FileReader.hpp"
+#include "Error.hpp"
+#include <filesystem>
+#include <cstring>
+#include <cerrno>
+
+namespace Pigeon
+{
+    /// @brief Open the file for reading in binary mode. Directories can be opened on some systems, so they are rejected explicitly
+    static FILE *openForReading(std::string const &path, std::error_code &error)
+    {
+        if (std::filesystem::is_directory(path, error))
+        {
+            error = std::make_error_code(std::errc::is_a_directory);
+            return nullptr;
+        }
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+        // 'e' sets O_CLOEXEC, so programs started by the script don't inherit the file
+        FILE *file = fopen(path.c_str(), "rbe");
+#else
+        FILE *file = fopen(path.c_str(), "rb");
+#endif
+        if (file == nullptr)
+        {
+            error = std::error_code(errno, std::generic_category());
+        }
+        else
+        {
+            error.clear();
+        }
+        return file;
+    }
+
+    std::optional<std::string> readFile(std::string const &path, std::error_code &error)
+    {
+        FILE *file = openForReading(path, error);
+        if (file == nullptr)
+        {
+            return std::nullopt;
+        }
+        // the size is only a hint, file can still change while it is being read. One more byte than expected is needed to notice the end of the file
+        std::error_code ignored;
+        uintmax_t expectedSize = std::filesystem::file_size(path, ignored);
+        std::string contents(ignored ? 1 << 16 : expectedSize + 1, '\0');
+        size_t size = 0;
+        while (true)
+        {
+            if (size == contents.size())
+            {
+                contents.resize(contents.size() * 2);
+            }
+            size_t count = fread(contents.data() + size, 1, contents.size() - size, file);
+            if (count == 0)
+            {
+                if (ferror(file))
+                {
+                    error = std::error_code(errno, std::generic_category());
+                    fclose(file);
+                    return std::nullopt;
+                }
+                break;
+            }
+            size += count;
+        }
+        fclose(file);
+        contents.resize(size);
+        return contents;
+    }
+
+    LineReader::LineReader(std::string const &path) : m_path(path), m_buffer(BufferSize)
+    {
+        std::error_code error;
+        m_file = openForReading(path, error);
+        if (m_file == nullptr)
+        {
+            throw RuntimeActionExecutionError(path + ": " + error.message());
+        }
+    }
+
+    bool LineReader::fill()
+    {
+        if (m_start > 0)
+        {
+            // data that was already returned is dropped to make space
+            std::memmove(m_buffer.data(), m_buffer.data() + m_start, m_end - m_start);
+            m_end -= m_start;
+            m_start = 0;
+        }
+        if (m_end == m_buffer.size())
+        {
+            // line doesn't fit into the buffer
+            m_buffer.resize(m_buffer.size() * 2);
+        }
+        size_t count = fread(m_buffer.data() + m_end, 1, m_buffer.size() - m_end, m_file);
+        if (count == 0 && ferror(m_file))
+        {
+            throw RuntimeActionExecutionError(m_path + ": " + strerror(errno));
+        }
+        m_end += count;
+        return count > 0;
+    }
+
+    bool LineReader::next(std::string &line)
+    {
+        size_t searched = m_start;
+        while (true)
+        {
+            char const *newLine = static_cast<char const *>(std::memchr(m_buffer.data() + searched, '\n', m_end - searched));
+            if (newLine != nullptr)
+            {
+                size_t end = newLine - m_buffer.data();
+                line.assign(m_buffer.data() + m_start, end - m_start);
+                m_start = end + 1;
+                return true;
+            }
+            // search continues after the data that was already checked, which is moved to the start of the buffer by fill
+            searched = m_end - m_start;
+            if (!fill())
+            {
+                break;
+            }
+        }
+        if (m_start == m_end)
+        {
+            return false;
+        }
+        line.assign(m_buffer.data() + m_start, m_end - m_start);
+        m_start = m_end;
+        return true;
+    }
+
+    LineReader::~LineReader()
+    {
+        fclose(m_file);
+    }
+}
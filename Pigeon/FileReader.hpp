@@ -0,0 +1,50 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <optional>
+#include <system_error>
+
+namespace Pigeon
+{
+    /// @brief Read the whole file into a string that owns its contents, so that changes made to the file afterwards don't affect it
+    /// @param path Path to the file
+    /// @param error Set to the reason if file can't be read
+    /// @return Contents of the file or None on error
+    std::optional<std::string> readFile(std::string const &path, std::error_code &error);
+
+    /// @brief Reads lines of the file one at a time using a fixed size buffer, so memory use depends only on the length of the longest line
+    class LineReader
+    {
+    public:
+        /// @brief Size of the buffer that the file is read into
+        static constexpr size_t BufferSize = 1 << 20;
+
+        /// @brief Open the file for reading. RuntimeActionExecutionError is thrown if the file can't be opened
+        /// @param path Path to the file
+        explicit LineReader(std::string const &path);
+
+        LineReader(LineReader const &) = delete;
+
+        /// @brief Read the next line without the new line character. Last line doesn't have to end with a new line.
+        /// RuntimeActionExecutionError is thrown if the file can't be read
+        /// @param line String that receives the line
+        /// @return False once the end of the file is reached
+        bool next(std::string &line);
+
+        ~LineReader();
+
+    private:
+        /// @brief Read more of the file into the buffer, after the data that wasn't used yet
+        /// @return False if nothing more could be read
+        bool fill();
+
+        std::string m_path;
+        FILE *m_file;
+        std::vector<char> m_buffer;
+        /// @brief Start of the data in the buffer that wasn't returned yet
+        size_t m_start = 0;
+        /// @brief End of the data read into the buffer
+        size_t m_end = 0;
+    };
+}
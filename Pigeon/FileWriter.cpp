@@ -0,0 +1,69 @@
+#include "FileWriter.hpp"
+#include "Error.hpp"
+#include <cstring>
+#include <cerrno>
+
+namespace Pigeon
+{
+    int64_t FileWriterManager::open(std::string const &path, bool append)
+    {
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+        // 'e' sets O_CLOEXEC, so programs started by the script don't inherit the file
+        FILE *file = fopen(path.c_str(), append ? "abe" : "wbe");
+#else
+        FILE *file = fopen(path.c_str(), append ? "ab" : "wb");
+#endif
+        if (file == nullptr)
+        {
+            throw RuntimeActionExecutionError(path + ": " + strerror(errno));
+        }
+        // data larger than the buffer is written directly, smaller writes are collected until the buffer is full
+        setvbuf(file, nullptr, _IOFBF, BufferSize);
+        int64_t handle = m_nextHandle++;
+        m_writers[handle] = FileWriter{.path = path, .file = file};
+        return handle;
+    }
+
+    bool FileWriterManager::write(int64_t handle, std::string_view data)
+    {
+        FileWriter &writer = getWriter(handle);
+        return fwrite(data.data(), 1, data.size(), writer.file) == data.size();
+    }
+
+    bool FileWriterManager::flush(int64_t handle)
+    {
+        return fflush(getWriter(handle).file) == 0;
+    }
+
+    bool FileWriterManager::close(int64_t handle)
+    {
+        FileWriter &writer = getWriter(handle);
+        // errors of buffered writes can only be noticed now
+        bool success = ferror(writer.file) == 0;
+        success = fclose(writer.file) == 0 && success;
+        m_writers.erase(handle);
+        return success;
+    }
+
+    std::string const &FileWriterManager::getPath(int64_t handle)
+    {
+        return getWriter(handle).path;
+    }
+
+    FileWriterManager::~FileWriterManager()
+    {
+        for (std::pair<const int64_t, FileWriter> &writer : m_writers)
+        {
+            fclose(writer.second.file);
+        }
+    }
+
+    FileWriterManager::FileWriter &FileWriterManager::getWriter(int64_t handle)
+    {
+        if (std::map<int64_t, FileWriter>::iterator it = m_writers.find(handle); it != m_writers.end())
+        {
+            return it->second;
+        }
+        throw RuntimeActionExecutionError("No open file with handle " + std::to_string(handle));
+    }
+}
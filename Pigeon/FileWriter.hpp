@@ -0,0 +1,66 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+
+namespace Pigeon
+{
+    /// @brief Owns files opened for writing by the script. Data is collected in a large buffer and only written to the file once the buffer is full,
+    /// so writing many small values doesn't cost a system call for each of them
+    class FileWriterManager
+    {
+    public:
+        /// @brief Size of the buffer of each file
+        static constexpr size_t BufferSize = 1 << 20;
+
+        explicit FileWriterManager() = default;
+
+        FileWriterManager(FileWriterManager const &) = delete;
+
+        /// @brief Open the file for writing, creating it if it doesn't exist
+        /// @param path Path to the file
+        /// @param append Should data be added to the end of the file instead of replacing its contents
+        /// @return Handle used to refer to the file in other calls
+        int64_t open(std::string const &path, bool append);
+
+        /// @brief Add data to the buffer of the file, writing the buffer out if it becomes full
+        /// @param handle Handle returned by `open`
+        /// @param data
+        /// @return False if data could not be written
+        bool write(int64_t handle, std::string_view data);
+
+        /// @brief Write everything that is in the buffer into the file
+        /// @param handle Handle returned by `open`
+        /// @return False if data could not be written
+        bool flush(int64_t handle);
+
+        /// @brief Write out the buffer and close the file. After this the handle is no longer valid
+        /// @param handle Handle returned by `open`
+        /// @return False if data could not be written
+        bool close(int64_t handle);
+
+        /// @brief Get path that the file was opened with
+        /// @param handle Handle returned by `open`
+        std::string const &getPath(int64_t handle);
+
+        /// @brief Check if there are no files that were not closed
+        bool isEmpty() const { return m_writers.empty(); }
+
+        /// @brief Writes out and closes all files that are still open
+        ~FileWriterManager();
+
+    private:
+        struct FileWriter
+        {
+            std::string path;
+            FILE *file;
+        };
+
+        FileWriter &getWriter(int64_t handle);
+
+        std::map<int64_t, FileWriter> m_writers;
+        int64_t m_nextHandle = 1;
+    };
+}
@@ -0,0 +1,287 @@
+#include "Isolate.hpp"
+#include "State.hpp"
+#include "Array.hpp"
+#include "Error.hpp"
+#include <algorithm>
+
+namespace Pigeon
+{
+    /// @brief Copy the value remembering arrays that are being copied, since an array that contains itself can't be copied
+    static SharedValue exportValue(Value const &value, std::vector<ArrayNode const *> &parents)
+    {
+        switch (value.index())
+        {
+        case ValueType::Integer:
+            return SharedValue{.value = getValueAsInt(value)};
+        case ValueType::String:
+            return SharedValue{.value = std::string(getValueAsString(value)->getView())};
+        case ValueType::Array:
+        {
+            ArrayNode const *array = getValueAsArray(value);
+            if (std::find(parents.begin(), parents.end(), array) != parents.end())
+            {
+                throw RuntimeActionExecutionError("Array that contains itself can't be copied into another isolate");
+            }
+            parents.push_back(array);
+            SharedArray items;
+            items.reserve(array->getLen());
+            for (size_t i = 0; i < array->getLen(); i++)
+            {
+                items.push_back(exportValue(array->getValueAt(i).value(), parents));
+            }
+            parents.pop_back();
+            return SharedValue{.value = std::move(items)};
+        }
+        case ValueType::FunctionRef:
+            return SharedValue{.value = getValueAsFunction(value)};
+        case ValueType::Sequence:
+            throw RuntimeActionExecutionError("Sequence can't be copied into another isolate, use `force` to turn it into an array first");
+        default:
+            throw RuntimeActionExecutionError("Value of this type can't be copied into another isolate");
+        }
+    }
+
+    SharedValue exportValue(Value const &value)
+    {
+        std::vector<ArrayNode const *> parents;
+        return exportValue(value, parents);
+    }
+
+    Value importValue(State &state, SharedValue const &value)
+    {
+        switch (value.value.index())
+        {
+        case 0:
+            return std::get<IntegerType>(value.value);
+        case 1:
+            return state.createString(std::get<std::string>(value.value));
+        case 2:
+        {
+            SharedArray const &items = std::get<SharedArray>(value.value);
+            std::vector<Value> values;
+            values.reserve(items.size());
+            for (SharedValue const &item : items)
+            {
+                values.push_back(importValue(state, item));
+            }
+            return state.createArray(values);
+        }
+        default:
+            return std::get<FunctionReference>(value.value);
+        }
+    }
+
+    bool Channel::send(SharedValue value)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_closed)
+            {
+                return false;
+            }
+            m_values.push_back(std::move(value));
+        }
+        m_available.notify_one();
+        return true;
+    }
+
+    std::optional<SharedValue> Channel::receive()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_available.wait(lock, [this]()
+                         { return !m_values.empty() || m_closed; });
+        if (m_values.empty())
+        {
+            return {};
+        }
+        SharedValue value = std::move(m_values.front());
+        m_values.pop_front();
+        return value;
+    }
+
+    void Channel::close()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_closed = true;
+        }
+        m_available.notify_all();
+    }
+
+    int64_t ChannelRegistry::create()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int64_t handle = m_nextHandle++;
+        m_channels[handle] = std::make_shared<Channel>();
+        return handle;
+    }
+
+    std::shared_ptr<Channel> ChannelRegistry::get(int64_t handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (std::map<int64_t, std::shared_ptr<Channel>>::iterator it = m_channels.find(handle); it != m_channels.end())
+        {
+            return it->second;
+        }
+        throw RuntimeActionExecutionError("No channel with handle " + std::to_string(handle));
+    }
+
+    /// @brief Amount of tasks running on this thread, more than one if the thread runs other tasks while waiting
+    static thread_local size_t RunningTaskCount = 0;
+
+    Task::Task(std::function<SharedValue()> function) : m_function(std::move(function))
+    {
+    }
+
+    void Task::run()
+    {
+        if (m_started.exchange(true))
+        {
+            return;
+        }
+        RunningTaskCount++;
+        try
+        {
+            m_result = m_function();
+        }
+        catch (ExitRequest const &e)
+        {
+            m_error = e.what();
+            m_exitCode = e.getCode();
+        }
+        catch (std::exception const &e)
+        {
+            m_error = e.what();
+        }
+        RunningTaskCount--;
+        m_finished.store(true, std::memory_order_release);
+        m_finished.notify_all();
+    }
+
+    void Task::cancel()
+    {
+        if (m_started.exchange(true))
+        {
+            return;
+        }
+        m_error = "Task was cancelled";
+        m_finished.store(true, std::memory_order_release);
+        m_finished.notify_all();
+    }
+
+    void Task::wait() const
+    {
+        m_finished.wait(false, std::memory_order_acquire);
+    }
+
+    bool Task::isRunningOnCurrentThread()
+    {
+        return RunningTaskCount > 0;
+    }
+
+    Task::~Task() = default;
+
+    int64_t TaskManager::add(std::shared_ptr<Task> task)
+    {
+        int64_t handle = m_nextHandle++;
+        m_tasks[handle] = std::move(task);
+        return handle;
+    }
+
+    std::shared_ptr<Task> TaskManager::take(int64_t handle)
+    {
+        std::map<int64_t, std::shared_ptr<Task>>::iterator it = m_tasks.find(handle);
+        if (it == m_tasks.end())
+        {
+            throw RuntimeActionExecutionError("No task with handle " + std::to_string(handle));
+        }
+        std::shared_ptr<Task> task = std::move(it->second);
+        m_tasks.erase(it);
+        return task;
+    }
+
+    void TaskManager::stopAll()
+    {
+        // queued tasks are cancelled first, so that waiting for the running ones doesn't also wait for those to get a thread
+        for (std::pair<int64_t const, std::shared_ptr<Task>> const &task : m_tasks)
+        {
+            task.second->cancel();
+        }
+        for (std::pair<int64_t const, std::shared_ptr<Task>> const &task : m_tasks)
+        {
+            task.second->wait();
+        }
+        m_tasks.clear();
+    }
+
+    TaskManager::~TaskManager()
+    {
+        stopAll();
+    }
+
+    Isolate::Isolate(std::unique_ptr<State> state, std::function<Value(State &)> task) : m_state(std::move(state)), m_task([this, task = std::move(task)]()
+                                                                                                                         { return runInState(task); })
+    {
+        m_thread = std::thread(&Task::run, &m_task);
+    }
+
+    SharedValue Isolate::runInState(std::function<Value(State &)> const &task)
+    {
+        try
+        {
+            SharedValue result = exportValue(task(*m_state));
+            m_state.reset();
+            return result;
+        }
+        catch (...)
+        {
+            m_state.reset();
+            throw;
+        }
+    }
+
+    SharedValue Isolate::join()
+    {
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+        if (m_task.getExitCode().has_value())
+        {
+            throw ExitRequest(m_task.getExitCode().value());
+        }
+        if (m_task.getError().has_value())
+        {
+            throw RuntimeActionExecutionError("Isolate failed: " + m_task.getError().value());
+        }
+        return m_task.getResult();
+    }
+
+    Isolate::~Isolate()
+    {
+        if (m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    int64_t IsolateManager::start(std::unique_ptr<State> state, std::function<Value(State &)> task)
+    {
+        int64_t handle = m_nextHandle++;
+        m_isolates[handle] = std::make_unique<Isolate>(std::move(state), std::move(task));
+        return handle;
+    }
+
+    SharedValue IsolateManager::join(int64_t handle)
+    {
+        std::map<int64_t, std::unique_ptr<Isolate>>::iterator it = m_isolates.find(handle);
+        if (it == m_isolates.end())
+        {
+            throw RuntimeActionExecutionError("No isolate with handle " + std::to_string(handle));
+        }
+        // isolate is forgotten even if it failed, its error is only reported once
+        std::unique_ptr<Isolate> isolate = std::move(it->second);
+        m_isolates.erase(it);
+        return isolate->join();
+    }
+}
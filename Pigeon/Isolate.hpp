@@ -0,0 +1,210 @@
+#pragma once
+#include "Value.hpp"
+#include <string>
+#include <vector>
+#include <variant>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <thread>
+#include <optional>
+#include <atomic>
+
+class State;
+
+namespace Pigeon
+{
+    struct SharedValue;
+
+    using SharedArray = std::vector<SharedValue>;
+
+    /// @brief Copy of the value that doesn't belong to any state, used to pass values between states that run on different threads
+    struct SharedValue
+    {
+        std::variant<IntegerType, std::string, SharedArray, FunctionReference> value;
+    };
+
+    /// @brief Copy the value and everything it references out of the state memory.
+    /// References to user functions stay valid only in states that share the function table, which is true for isolates started by the state
+    /// @param value
+    /// @return
+    SharedValue exportValue(Value const &value);
+
+    /// @brief Create a copy of the shared value in the state memory
+    /// @param state
+    /// @param value
+    /// @return
+    Value importValue(State &state, SharedValue const &value);
+
+    /// @brief Queue of values sent between isolates. Values are copied on both ends, so no memory is ever shared between states
+    class Channel
+    {
+    public:
+        /// @brief Add the value to the end of the queue
+        /// @param value
+        /// @return False if channel was closed
+        bool send(SharedValue value);
+
+        /// @brief Take the value from the start of the queue, blocking until there is one
+        /// @return Value or None if channel was closed and all values sent before that were received
+        std::optional<SharedValue> receive();
+
+        /// @brief Stop accepting new values and wake up everyone waiting for one
+        void close();
+
+    private:
+        std::mutex m_mutex;
+        std::condition_variable m_available;
+        std::deque<SharedValue> m_values;
+        bool m_closed = false;
+    };
+
+    /// @brief Channels that can be used by a state and all isolates started by it. Channels are referred to by handles, since values can't be shared
+    class ChannelRegistry
+    {
+    public:
+        /// @brief Create a new open channel
+        /// @return Handle used to refer to the channel in any state that uses this registry
+        int64_t create();
+
+        /// @brief Get channel by the handle returned by `create`
+        std::shared_ptr<Channel> get(int64_t handle);
+
+    private:
+        std::mutex m_mutex;
+        std::map<int64_t, std::shared_ptr<Channel>> m_channels;
+        int64_t m_nextHandle = 1;
+    };
+
+    /// @brief Function call that runs in a state of its own, on a thread other than the one that created it
+    class Task
+    {
+    public:
+        /// @param function Function that is called by `run`. It runs in a state that no other thread uses and returns the result already copied out of it
+        explicit Task(std::function<SharedValue()> function);
+
+        Task(Task const &) = delete;
+
+        /// @brief Call the function on the current thread. Does nothing if the task was cancelled
+        void run();
+
+        /// @brief Make sure the function is never called if `run` didn't start yet, in which case the task finishes with an error
+        void cancel();
+
+        /// @brief Block until the task is finished or cancelled
+        void wait() const;
+
+        /// @brief Check if `run` has finished or the task was cancelled, after which result and error can be read from any thread
+        bool isFinished() const { return m_finished.load(std::memory_order_acquire); }
+
+        /// @brief Get the copy of the value returned by the function
+        SharedValue const &getResult() const { return m_result; }
+
+        /// @brief Get message of the error that stopped the function or None if it succeeded
+        std::optional<std::string> const &getError() const { return m_error; }
+
+        /// @brief Get the exit code if the function called `exit`, which can only end the script once the task is joined
+        std::optional<int> const &getExitCode() const { return m_exitCode; }
+
+        /// @brief Check if the current thread is running a task, including tasks that run while the thread waits for another task
+        static bool isRunningOnCurrentThread();
+
+        ~Task();
+
+    private:
+        std::function<SharedValue()> m_function;
+        SharedValue m_result;
+        std::optional<std::string> m_error;
+        std::optional<int> m_exitCode;
+        /// @brief Set by whichever of `run` and `cancel` comes first
+        std::atomic<bool> m_started = false;
+        std::atomic<bool> m_finished = false;
+    };
+
+    /// @brief Tasks started by a state that were not joined yet, referred to by handles
+    class TaskManager
+    {
+    public:
+        explicit TaskManager() = default;
+
+        TaskManager(TaskManager const &) = delete;
+
+        /// @brief Remember the task
+        /// @return Handle used to get the task back
+        int64_t add(std::shared_ptr<Task> task);
+
+        /// @brief Get the task and forget it. After this the handle is no longer valid
+        /// @param handle Handle returned by `add`
+        std::shared_ptr<Task> take(int64_t handle);
+
+        /// @brief Cancel tasks that didn't start yet and wait for the ones that are running, then forget all of them
+        void stopAll();
+
+        /// @brief Stops tasks that were never joined, so that none of them outlives the state that started it
+        ~TaskManager();
+
+    private:
+        std::map<int64_t, std::shared_ptr<Task>> m_tasks;
+        int64_t m_nextHandle = 1;
+    };
+
+    /// @brief State running on its own thread. The state isn't accessed by anything else while the isolate runs, and the result is copied out of it
+    class Isolate
+    {
+    public:
+        /// @brief Start the thread that runs the task in the state
+        /// @param state State owned by the isolate, usually created with `State::createIsolatedState` or running its own program
+        /// @param task Function that is called on the new thread, its result is copied out of the state
+        explicit Isolate(std::unique_ptr<State> state, std::function<Value(State &)> task);
+
+        Isolate(Isolate const &) = delete;
+
+        /// @brief Wait for the task to finish.
+        /// RuntimeActionExecutionError with the error message is thrown if task failed and ExitRequest if it called `exit`
+        /// @return Copy of the value returned by the task
+        SharedValue join();
+
+        /// @brief Waits for the task to finish if it wasn't joined
+        ~Isolate();
+
+    private:
+        /// @brief Call the task in the state of the isolate and destroy the state afterwards
+        SharedValue runInState(std::function<Value(State &)> const &task);
+
+        /// @brief Destroyed by the thread once the task has finished, since only the copy of the result is needed
+        std::unique_ptr<State> m_state;
+        Task m_task;
+        std::thread m_thread;
+    };
+
+    /// @brief Isolates started by a state, referred to by handles
+    class IsolateManager
+    {
+    public:
+        explicit IsolateManager() = default;
+
+        IsolateManager(IsolateManager const &) = delete;
+
+        /// @brief Start an isolate
+        /// @param state State owned by the isolate
+        /// @param task Function that is called on the new thread
+        /// @return Handle used to join the isolate
+        int64_t start(std::unique_ptr<State> state, std::function<Value(State &)> task);
+
+        /// @brief Wait for the isolate to finish. After this the handle is no longer valid.
+        /// RuntimeActionExecutionError with the error message is thrown if task failed and ExitRequest if it called `exit`
+        /// @param handle Handle returned by `start`
+        /// @return Copy of the value returned by the task
+        SharedValue join(int64_t handle);
+
+        /// @brief Check if there are no isolates that were not joined
+        bool isEmpty() const { return m_isolates.empty(); }
+
+    private:
+        std::map<int64_t, std::unique_ptr<Isolate>> m_isolates;
+        int64_t m_nextHandle = 1;
+    };
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <string>
+#include <string_view>
 
 class MemoryNode
 {
@@ -44,12 +45,17 @@ class StringNode : public MemoryNode
 {
 public:
     explicit StringNode(std::string const &val) : m_value(val) {}
+    explicit StringNode(std::string &&val) : m_value(std::move(val)) {}
     explicit StringNode() {}
 
     size_t getLen() const override { return m_value.size(); }
 
+    /// @brief Get the string for modification
     std::string &getValue() { return m_value; }
 
+    /// @brief Get contents of the string, which should be used whenever the string is only read
+    std::string_view getView() const { return m_value; }
+
     virtual ~StringNode() {}
 
 private:
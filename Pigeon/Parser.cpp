@@ -264,7 +264,19 @@ namespace Pigeon::Parser
         }
         consumeCharacter(')', it, end, "Expected ')'");
         skipNotCode(it, end);
-        std::unique_ptr<Action> body = parseFunction(it, end);
+        std::unique_ptr<Action> body = nullptr;
+        if (it != end && *it == '(')
+        {
+            // most of the functions in a library are never called, so we only check the structure here
+            // and leave the actual parsing to the first call
+            std::string::const_iterator bodyStart = it;
+            skipBracketedExpression(it, end);
+            body = std::make_unique<LazyFunctionBodyAction>(bodyStart, it);
+        }
+        else
+        {
+            body = parseFunction(it, end);
+        }
         if (body == nullptr)
         {
             throwParsingError(it, "Expected function body");
@@ -275,6 +287,87 @@ namespace Pigeon::Parser
         return std::make_unique<FunctionDeclarationAction>(start, name.value(), std::move(body), argumentNames);
     }
 
+    void skipBracketedExpression(std::string::const_iterator &start, std::string::const_iterator const &end)
+    {
+        std::vector<std::string::const_iterator> openBrackets;
+        // strings, characters and comments can only start where parser would expect a new value
+        bool atTokenStart = true;
+        for (std::string::const_iterator it = start; it != end; it++)
+        {
+            char c = *it;
+            if (atTokenStart && c == ';')
+            {
+                std::string::const_iterator commentStart = it;
+                for (it++; it != end && *it != ';'; it++)
+                {
+                }
+                if (it == end)
+                {
+                    throwParsingError(commentStart, "Expected ';' at the end of the comment");
+                }
+                continue;
+            }
+            if (atTokenStart && c == '"')
+            {
+                std::string::const_iterator stringStart = it;
+                for (it++; it != end && *it != '"'; it++)
+                {
+                    if (*it == '\\' && it + 1 != end)
+                    {
+                        it++;
+                    }
+                }
+                if (it == end)
+                {
+                    throwParsingError(stringStart, "expected closing '\"'");
+                }
+                atTokenStart = false;
+                continue;
+            }
+            if (atTokenStart && c == '\'')
+            {
+                // skip the character itself so that '(' and ')' are not counted
+                size_t length = (it + 1 != end && *(it + 1) == '\\') ? 3 : 2;
+                for (size_t i = 0; i < length && it + 1 != end; i++)
+                {
+                    it++;
+                }
+                atTokenStart = false;
+                continue;
+            }
+            switch (c)
+            {
+            case '(':
+                openBrackets.push_back(it);
+                atTokenStart = true;
+                break;
+            case ')':
+                if (openBrackets.empty())
+                {
+                    throwParsingError(it, "Unexpected ')'");
+                }
+                openBrackets.pop_back();
+                if (openBrackets.empty())
+                {
+                    start = it + 1;
+                    return;
+                }
+                atTokenStart = true;
+                break;
+            case ' ':
+            case '\n':
+            case '\t':
+            case '\r':
+                atTokenStart = true;
+                break;
+            default:
+                atTokenStart = false;
+                break;
+            }
+        }
+        throwParsingError(openBrackets.empty() ? start : openBrackets.back(), "Expected ')'");
+    }
+
     std::unique_ptr<FunctionCallAction> parseUserFunctionCall(std::string::const_iterator &start, std::string::const_iterator const &end)
     {
         skipNotCode(start, end);
@@ -315,6 +408,20 @@ namespace Pigeon::Parser
             start = it;
             return var;
         }
+        else if (expectString("capture", it, end))
+        {
+            it += 7;
+            std::unique_ptr<CommandCallAction> var = parseExplicitCommandCall(it, end, CommandOutputMode::Capture);
+            start = it;
+            return var;
+        }
+        else if (expectString("measure", it, end))
+        {
+            it += 7;
+            std::unique_ptr<CommandCallAction> var = parseExplicitCommandCall(it, end, CommandOutputMode::Measure);
+            start = it;
+            return var;
+        }
         else if (expectString("call", it, end))
         {
             it += 4;
@@ -478,17 +585,50 @@ namespace Pigeon::Parser
         return actions;
     }
 
-    std::unique_ptr<CommandCallAction> parseCommandCall(std::unique_ptr<Action> commandNameAction, std::string::const_iterator &start, std::string::const_iterator end)
+    std::unique_ptr<CommandCallAction> parseCommandCall(std::unique_ptr<Action> commandNameAction, std::string::const_iterator &start, std::string::const_iterator end, CommandOutputMode mode)
     {
         std::string::const_iterator it = start;
-        std::vector<std::unique_ptr<Action>> args = parseArguments(it, end);
-        std::unique_ptr<CommandCallAction> exec = std::make_unique<CommandCallAction>(it, std::move(commandNameAction), std::move(args));
+        std::vector<std::unique_ptr<Action>> args;
+        std::vector<CommandRedirection> redirections;
+        bool mergeErrorOutput = false;
+        // redirection can come right after the program name, which doesn't skip the space after itself
+        skipNotCode(it, end);
+        while (it != end && *it != ')')
+        {
+            if (expectString("2>&1", it, end))
+            {
+                it += 4;
+                mergeErrorOutput = true;
+            }
+            else if (std::vector<std::pair<std::string, CommandRedirectionType>>::const_iterator redirection = std::find_if(
+                         CommandRedirections.begin(),
+                         CommandRedirections.end(),
+                         [it, end](std::pair<std::string, CommandRedirectionType> const &r)
+                         { return expectString(r.first, it, end); });
+                     redirection != CommandRedirections.end())
+            {
+                it += redirection->first.size();
+                skipNotCode(it, end);
+                std::unique_ptr<Action> target = parseFunction(it, end);
+                if (target == nullptr)
+                {
+                    throwParsingError(it, "Expected file path after '" + redirection->first + "'");
+                }
+                redirections.push_back(CommandRedirection{.type = redirection->second, .target = std::move(target)});
+            }
+            else
+            {
+                args.push_back(parseFunction(it, end));
+            }
+            skipNotCode(it, end);
+        }
+        std::unique_ptr<CommandCallAction> exec = std::make_unique<CommandCallAction>(it, std::move(commandNameAction), std::move(args), mode, mergeErrorOutput, std::move(redirections));
         skipNotCode(it, end);
         start = it;
         return exec;
     }
 
-    std::unique_ptr<CommandCallAction> parseExplicitCommandCall(std::string::const_iterator &start, std::string::const_iterator end)
+    std::unique_ptr<CommandCallAction> parseExplicitCommandCall(std::string::const_iterator &start, std::string::const_iterator end, CommandOutputMode mode)
     {
         skipNotCode(start, end);
         std::unique_ptr<GetConstStringAction> action = parseConstString(start, end);
@@ -496,7 +636,7 @@ namespace Pigeon::Parser
         {
             throwParsingError(start, "Expected command name");
         }
-        return parseCommandCall(std::move(action), start, end);
+        return parseCommandCall(std::move(action), start, end, mode);
     }
 
     std::unique_ptr<BinaryOperationAction> parseBinaryOperation(Operator op, std::string::const_iterator &start, std::string::const_iterator end)
@@ -14,6 +14,14 @@ namespace Pigeon::Parser
     /// @brief List of all keywords that should not be confused for strings
     static const std::vector<std::string> Keywords = {"if", "else", "exec", "print", "array", "seq", "len"};
 
+    /// @brief Tokens that redirect standard streams of the program called with `exec`
+    static const std::vector<std::pair<std::string, CommandRedirectionType>> CommandRedirections = {
+        {"<", CommandRedirectionType::Input},
+        {">", CommandRedirectionType::Output},
+        {">>", CommandRedirectionType::OutputAppend},
+        {"2>", CommandRedirectionType::ErrorOutput},
+        {"2>>", CommandRedirectionType::ErrorOutputAppend}};
+
     struct SpecialCharacter
     {
         const char *sequence;
@@ -79,6 +87,11 @@ namespace Pigeon::Parser
     /// @return
     std::unique_ptr<FunctionDeclarationAction> parseUserFunctionDeclaration(std::string::const_iterator &start, std::string::const_iterator const &end);
 
+    /// @brief Skip over a bracketed expression only checking that brackets, strings and comments are closed. Used to avoid parsing function bodies that are never called
+    /// @param start Iterator pointing at the opening bracket, on success it is moved past the matching closing bracket
+    /// @param end
+    void skipBracketedExpression(std::string::const_iterator &start, std::string::const_iterator const &end);
+
     /// @brief Parse call to a function following `(call name arg arg arg)`
     /// @param start
     /// @param end
@@ -116,24 +129,28 @@ namespace Pigeon::Parser
     std::unique_ptr<FunctionAccessAction> parseFunctionAccess(std::string::const_iterator &start, std::string::const_iterator const &end);
 
     /**
-     * @brief Parse a system call. Written as any other operation but all arguments will be passed to the called program
+     * @brief Parse a system call. Written as any other operation but all arguments will be passed to the called program.
+     * `2>&1` among the arguments is not passed to the program and instead makes captured output include stderr.
+     * Redirections such as `> path` or `< path` are also not passed to the program and instead replace standard streams with files
      *
      * @param commandNameAction Action returning name of the program
      * @param start
      * @param end
+     * @param mode What should be done with the output of the program
      * @return std::unique_ptr<CommandCallAction>
      */
-    std::unique_ptr<CommandCallAction> parseCommandCall(std::unique_ptr<Action> commandNameAction, std::string::const_iterator &start, std::string::const_iterator end);
+    std::unique_ptr<CommandCallAction> parseCommandCall(std::unique_ptr<Action> commandNameAction, std::string::const_iterator &start, std::string::const_iterator end, CommandOutputMode mode = CommandOutputMode::Print);
 
     /**
-     * @brief Parse a system call, unlike `parseCommandCall` this expected `exec` at the start
+     * @brief Parse a system call, unlike `parseCommandCall` this expected `exec`, `capture` or `measure` at the start
      *
      * @param commandNameAction Action returning name of the program
      * @param start
      * @param end
+     * @param mode What should be done with the output of the program
      * @return std::unique_ptr<CommandCallAction>
      */
-    std::unique_ptr<CommandCallAction> parseExplicitCommandCall(std::string::const_iterator &start, std::string::const_iterator end);
+    std::unique_ptr<CommandCallAction> parseExplicitCommandCall(std::string::const_iterator &start, std::string::const_iterator end, CommandOutputMode mode = CommandOutputMode::Print);
 
     /// @brief Parse binary operation that doesn't modify the environment. Always expects two arguments
     /// @param op
@@ -0,0 +1,1323 @@
+#include "Process.hpp"
+#include "Error.hpp"
+#include <iostream>
+#include <algorithm>
+#include <cstring>
+#include <climits>
+
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+#include <spawn.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include <string.h>
+#include <errno.h>
+
+extern char **environ;
+
+namespace Pigeon::Process
+{
+    std::string CommandPathCache::resolve(std::string const &program)
+    {
+        if (program.empty() || program.find('/') != std::string::npos)
+        {
+            return program;
+        }
+        const char *pathVariable = getenv("PATH");
+        // this is the same default that execvp uses
+        std::string currentPath = pathVariable != nullptr ? pathVariable : "/bin:/usr/bin";
+        if (currentPath != m_pathVariable)
+        {
+            m_paths.clear();
+            m_pathVariable = currentPath;
+        }
+        if (std::unordered_map<std::string, std::string>::const_iterator it = m_paths.find(program); it != m_paths.end())
+        {
+            m_hits++;
+            return it->second;
+        }
+        m_misses++;
+        size_t dirStart = 0;
+        while (dirStart <= currentPath.size())
+        {
+            size_t dirEnd = currentPath.find(':', dirStart);
+            if (dirEnd == std::string::npos)
+            {
+                dirEnd = currentPath.size();
+            }
+            std::string dir = currentPath.substr(dirStart, dirEnd - dirStart);
+            std::string candidate = (dir.empty() ? "." : dir) + "/" + program;
+            struct stat info;
+            if (stat(candidate.c_str(), &info) == 0 && S_ISREG(info.st_mode) && access(candidate.c_str(), X_OK) == 0)
+            {
+                // relative directories depend on current directory, so those are not remembered
+                if (!dir.empty() && dir[0] == '/')
+                {
+                    m_paths[program] = candidate;
+                }
+                return candidate;
+            }
+            dirStart = dirEnd + 1;
+        }
+        return program;
+    }
+
+    void CommandPathCache::forget(std::string const &program)
+    {
+        m_paths.erase(program);
+    }
+
+    void CommandPathCache::clear()
+    {
+        m_paths.clear();
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+    /// @brief Find out if spawning failed because one of the files couldn't be opened, which gives the same errors as a missing program.
+    /// Files are opened in the same order as the child does, so the one that failed there is the first one that fails here
+    /// @return Error message naming the file that can't be opened or None if all files can be opened
+    static std::optional<std::string> findFailedRedirection(std::string const &program, SpawnOptions const &options)
+    {
+        for (FileRedirection const &file : options.files)
+        {
+            // contents were already truncated by the child if it got that far, so they are left alone here
+            int fd = open(file.path.c_str(), (file.flags & ~O_TRUNC) | O_CLOEXEC, 0666);
+            if (fd == -1)
+            {
+                return "Failed to open '" + file.path + "' for '" + program + "': " + strerror(errno);
+            }
+            close(fd);
+        }
+        return std::nullopt;
+    }
+
+    ProcessId spawnProcess(std::string const &program, std::vector<std::string> const &arguments, SpawnOptions const &options)
+    {
+        std::vector<char *> argv = {const_cast<char *>(program.c_str())};
+        for (std::string const &arg : arguments)
+        {
+            argv.push_back(const_cast<char *>(arg.c_str()));
+        }
+        argv.push_back(nullptr);
+
+        // file actions are applied in the child between vfork and exec, which replaces the dup2 calls we had to do manually after fork
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        for (int fd : options.closeFds)
+        {
+            posix_spawn_file_actions_addclose(&actions, fd);
+        }
+        int targets[3] = {options.stdinFd, options.stdoutFd, options.stderrFd};
+        for (int i = 0; i < 3; i++)
+        {
+            if (targets[i] != -1)
+            {
+                posix_spawn_file_actions_adddup2(&actions, targets[i], i);
+            }
+        }
+        bool errorRedirected = false;
+        for (FileRedirection const &file : options.files)
+        {
+            posix_spawn_file_actions_addopen(&actions, file.fd, file.path.c_str(), file.flags, 0666);
+            errorRedirected = errorRedirected || file.fd == STDERR_FILENO;
+        }
+        if (options.errorToOutput && !errorRedirected)
+        {
+            posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+        }
+
+        posix_spawnattr_t attributes;
+        posix_spawnattr_init(&attributes);
+        if (options.newProcessGroup)
+        {
+            // group id 0 means that child becomes the leader of a new group with id equal to its pid
+            posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETPGROUP);
+            posix_spawnattr_setpgroup(&attributes, 0);
+        }
+
+        pid_t pid;
+        std::string path = options.pathCache != nullptr ? options.pathCache->resolve(program) : program;
+        int err = posix_spawnp(&pid, path.c_str(), &actions, &attributes, argv.data(), environ);
+        std::optional<std::string> failedRedirection;
+        if (err == ENOENT || err == EACCES)
+        {
+            failedRedirection = findFailedRedirection(program, options);
+        }
+        if ((err == ENOENT || err == EACCES) && !failedRedirection.has_value() && path != program && access(path.c_str(), X_OK) != 0)
+        {
+            // program was moved or removed since we found it, so we have to search for it again
+            options.pathCache->forget(program);
+            err = posix_spawnp(&pid, program.c_str(), &actions, &attributes, argv.data(), environ);
+        }
+        posix_spawnattr_destroy(&attributes);
+        posix_spawn_file_actions_destroy(&actions);
+        if (failedRedirection.has_value())
+        {
+            throw RuntimeActionExecutionError(failedRedirection.value());
+        }
+        if (err != 0)
+        {
+            throw RuntimeActionExecutionError("Failed to start '" + program + "': " + strerror(err));
+        }
+        return pid;
+    }
+
+    /// @brief Write whole buffer, retrying on partial writes
+    /// @return False if write failed, for example because reader closed the pipe
+    static bool writeAll(int fd, const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t written = write(fd, data, size);
+            if (written == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return false;
+            }
+            data += written;
+            size -= written;
+        }
+        return true;
+    }
+
+    /// @brief Size of the chunks used for moving the output of the child processes
+    static constexpr size_t ForwardBufferSize = 1 << 16;
+
+    void forwardOutput(int fromFd, int toFd)
+    {
+#if defined(__linux__)
+        // splice only works when target is a file, pipe or socket, for terminal we fall back to the usual copying
+        while (true)
+        {
+            ssize_t moved = splice(fromFd, nullptr, toFd, nullptr, ForwardBufferSize, SPLICE_F_MOVE | SPLICE_F_MORE);
+            if (moved == 0)
+            {
+                return;
+            }
+            if (moved == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                break;
+            }
+        }
+#endif
+        std::vector<char> buffer(ForwardBufferSize);
+        bool canWrite = true;
+        while (true)
+        {
+            ssize_t count = read(fromFd, buffer.data(), buffer.size());
+            if (count == 0)
+            {
+                return;
+            }
+            if (count == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                return;
+            }
+            // even if we can't write we keep reading so the child doesn't get stuck on a full pipe
+            if (canWrite)
+            {
+                canWrite = writeAll(toFd, buffer.data(), count);
+            }
+        }
+    }
+
+    std::string readOutput(int fd)
+    {
+        // data is read straight into the string that will be used by the script, growing it as needed
+        std::string output;
+        size_t size = 0;
+        while (true)
+        {
+            if (output.size() - size < ForwardBufferSize)
+            {
+                output.resize(std::max(output.size() * 2, ForwardBufferSize));
+            }
+            ssize_t count = read(fd, output.data() + size, output.size() - size);
+            if (count == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                break;
+            }
+            size += count;
+        }
+        output.resize(size);
+        return output;
+    }
+
+    bool readLines(int fd, std::function<bool(std::string_view line)> const &callback)
+    {
+        std::vector<char> buffer(ForwardBufferSize);
+        // amount of data in the buffer that is part of the line that is not finished yet
+        size_t pending = 0;
+        while (true)
+        {
+            ssize_t count = read(fd, buffer.data() + pending, buffer.size() - pending);
+            if (count == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                break;
+            }
+            size_t size = pending + count;
+            size_t lineStart = 0;
+            for (size_t i = pending; i < size; i++)
+            {
+                if (buffer[i] == '\n')
+                {
+                    if (!callback(std::string_view(buffer.data() + lineStart, i - lineStart)))
+                    {
+                        return false;
+                    }
+                    lineStart = i + 1;
+                }
+            }
+            if (lineStart == 0 && size == buffer.size())
+            {
+                // line doesn't fit into the buffer, so we give out what we have to keep memory use fixed
+                if (!callback(std::string_view(buffer.data(), size)))
+                {
+                    return false;
+                }
+                lineStart = size;
+            }
+            pending = size - lineStart;
+            std::memmove(buffer.data(), buffer.data() + lineStart, pending);
+        }
+        if (pending > 0)
+        {
+            return callback(std::string_view(buffer.data(), pending));
+        }
+        return true;
+    }
+
+    void terminateProcess(ProcessId pid)
+    {
+        kill((pid_t)pid, SIGTERM);
+    }
+
+    static std::chrono::microseconds convertTime(timeval const &time)
+    {
+        return std::chrono::seconds(time.tv_sec) + std::chrono::microseconds(time.tv_usec);
+    }
+
+    /// @brief Decode status reported by wait4 and combine it with resource usage
+    static ProcessResult makeProcessResult(int status, rusage const &usage, std::chrono::steady_clock::time_point startTime)
+    {
+        ProcessResult result;
+        if (WIFSIGNALED(status))
+        {
+            result.signal = WTERMSIG(status);
+            result.exitCode = 128 + result.signal;
+        }
+        else
+        {
+            result.exitCode = WEXITSTATUS(status);
+        }
+        result.wallTime = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - startTime);
+        result.userTime = convertTime(usage.ru_utime);
+        result.systemTime = convertTime(usage.ru_stime);
+        // linux reports ru_maxrss in kilobytes
+        result.maxResidentKb = usage.ru_maxrss;
+        return result;
+    }
+
+    ProcessResult waitForProcess(ProcessId pid, std::chrono::steady_clock::time_point startTime)
+    {
+        int status = 0;
+        rusage usage{};
+        while (wait4((pid_t)pid, &status, 0, &usage) == -1)
+        {
+            if (errno != EINTR)
+            {
+                throw RuntimeActionExecutionError(std::string("Failed to wait for process: ") + strerror(errno));
+            }
+        }
+        return makeProcessResult(status, usage, startTime);
+    }
+
+    std::vector<ProcessResult> runCommandsInParallel(std::vector<Command> const &commands, size_t maxJobs, CommandPathCache *pathCache)
+    {
+        struct Job
+        {
+            size_t index;
+            ProcessId pid;
+            int fd;
+            std::chrono::steady_clock::time_point startTime;
+            std::string output;
+        };
+        std::vector<ProcessResult> results(commands.size());
+        std::vector<Job> running;
+        std::vector<char> buffer(ForwardBufferSize);
+        size_t next = 0;
+        maxJobs = maxJobs == 0 ? 1 : maxJobs;
+        // commands that are running when the call fails are stopped, so that they don't stay around as zombies with open pipes
+        auto stopRunning = [&running]()
+        {
+            for (Job const &job : running)
+            {
+                close(job.fd);
+                kill((pid_t)job.pid, SIGKILL);
+                waitForProcess(job.pid, job.startTime);
+            }
+            running.clear();
+        };
+        std::cout.flush();
+        while (next < commands.size() || !running.empty())
+        {
+            while (next < commands.size() && running.size() < maxJobs)
+            {
+                int pipefd[2];
+                if (pipe2(pipefd, O_CLOEXEC) == -1)
+                {
+                    std::string error = strerror(errno);
+                    stopRunning();
+                    throw RuntimeActionExecutionError("Failed to create pipe: " + error);
+                }
+                SpawnOptions options;
+                options.stdoutFd = pipefd[1];
+                options.stderrFd = pipefd[1];
+                options.pathCache = pathCache;
+                try
+                {
+                    std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+                    ProcessId pid = spawnProcess(commands[next].program, commands[next].arguments, options);
+                    running.push_back(Job{.index = next, .pid = pid, .fd = pipefd[0], .startTime = startTime});
+                }
+                catch (RuntimeActionExecutionError const &e)
+                {
+                    close(pipefd[0]);
+                    std::cerr << e.what() << std::endl;
+                    results[next] = getSpawnFailureResult();
+                }
+                close(pipefd[1]);
+                next++;
+            }
+            if (running.empty())
+            {
+                continue;
+            }
+
+            std::vector<pollfd> fds;
+            for (Job const &job : running)
+            {
+                fds.push_back(pollfd{.fd = job.fd, .events = POLLIN});
+            }
+            if (poll(fds.data(), fds.size(), -1) == -1)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                std::string error = strerror(errno);
+                stopRunning();
+                throw RuntimeActionExecutionError("Failed to wait for command output: " + error);
+            }
+            // go backwards so that finished jobs can be removed without breaking indices
+            for (size_t i = fds.size(); i-- > 0;)
+            {
+                if (fds[i].revents == 0)
+                {
+                    continue;
+                }
+                Job &job = running[i];
+                ssize_t count = read(job.fd, buffer.data(), buffer.size());
+                if (count > 0)
+                {
+                    job.output.append(buffer.data(), count);
+                    continue;
+                }
+                if (count == -1 && errno == EINTR)
+                {
+                    continue;
+                }
+                close(job.fd);
+                results[job.index] = waitForProcess(job.pid, job.startTime);
+                writeAll(STDOUT_FILENO, job.output.data(), job.output.size());
+                running.erase(running.begin() + i);
+            }
+        }
+        return results;
+    }
+
+    std::vector<ProcessResult> runPipeline(std::vector<Command> const &commands, CommandPathCache *pathCache)
+    {
+        std::vector<ProcessResult> results(commands.size());
+        std::vector<ProcessId> pids(commands.size(), -1);
+        // all commands of the pipeline run at the same time, so they share the start time
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        std::cout.flush();
+        // read end of the pipe connected to the previous command
+        int input = -1;
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            int pipefd[2] = {-1, -1};
+            if (i + 1 < commands.size() && pipe2(pipefd, O_CLOEXEC) == -1)
+            {
+                std::string error = strerror(errno);
+                if (input != -1)
+                {
+                    close(input);
+                }
+                // commands that already started can't be connected to the rest of the pipeline, so they are stopped instead of left running
+                for (size_t j = 0; j < i; j++)
+                {
+                    if (pids[j] != -1)
+                    {
+                        kill((pid_t)pids[j], SIGKILL);
+                        waitForProcess(pids[j], startTime);
+                    }
+                }
+                throw RuntimeActionExecutionError("Failed to create pipe: " + error);
+            }
+            SpawnOptions options;
+            options.stdinFd = input;
+            options.stdoutFd = pipefd[1];
+            options.pathCache = pathCache;
+            try
+            {
+                pids[i] = spawnProcess(commands[i].program, commands[i].arguments, options);
+            }
+            catch (RuntimeActionExecutionError const &e)
+            {
+                std::cerr << e.what() << std::endl;
+                results[i] = getSpawnFailureResult();
+            }
+            // only children should keep the pipe ends, otherwise readers will never see the end of the input
+            if (input != -1)
+            {
+                close(input);
+            }
+            if (pipefd[1] != -1)
+            {
+                close(pipefd[1]);
+            }
+            input = pipefd[0];
+        }
+        for (size_t i = 0; i < commands.size(); i++)
+        {
+            if (pids[i] != -1)
+            {
+                results[i] = waitForProcess(pids[i], startTime);
+            }
+        }
+        return results;
+    }
+
+    /// @brief Get descriptor that becomes readable once process exits. Done via syscall because older glibc versions have no wrapper for it
+    /// @return Descriptor or -1 if system doesn't support it
+    static int openPidFd(ProcessId pid)
+    {
+#if defined(SYS_pidfd_open)
+        return (int)syscall(SYS_pidfd_open, (pid_t)pid, 0);
+#else
+        return -1;
+#endif
+    }
+
+    /// @brief How long process group is given to exit after SIGTERM before it is killed
+    static constexpr std::chrono::milliseconds TerminationGracePeriod{2000};
+
+    /// @brief Wait until the process exits or the time runs out. Process is not reaped, so its result can still be collected with `waitForProcess`
+    /// @return True if the process has exited
+    static bool waitForExit(ProcessId pid, std::chrono::milliseconds timeout)
+    {
+        int pidFd = openPidFd(pid);
+        if (pidFd != -1)
+        {
+            pollfd exitEvent{.fd = pidFd, .events = POLLIN};
+            // poll takes an int, so longer waits are cut short instead of overflowing
+            int timeoutMs = (int)std::clamp<int64_t>(timeout.count(), 0, INT_MAX);
+            int ready;
+            while ((ready = ::poll(&exitEvent, 1, timeoutMs)) == -1 && errno == EINTR)
+            {
+            }
+            close(pidFd);
+            return ready == 1;
+        }
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+        while (true)
+        {
+            siginfo_t info{};
+            // WNOWAIT leaves the process to be reaped by whoever collects its result
+            if (waitid(P_PID, (id_t)pid, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid != 0)
+            {
+                return true;
+            }
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                return false;
+            }
+            usleep(10000);
+        }
+    }
+
+    /// @brief Ask the process to exit with SIGTERM and kill it with SIGKILL if it's still running after the grace period, same as commands that ran out of time
+    /// @return Result of the process
+    static ProcessResult stopProcess(ProcessId pid, std::chrono::steady_clock::time_point startTime)
+    {
+        kill((pid_t)pid, SIGTERM);
+        if (!waitForExit(pid, TerminationGracePeriod))
+        {
+            kill((pid_t)pid, SIGKILL);
+        }
+        return waitForProcess(pid, startTime);
+    }
+
+    ProcessResult runWithTimeout(Command const &command, std::chrono::milliseconds timeout, CommandPathCache *pathCache)
+    {
+        int pipefd[2];
+        if (pipe2(pipefd, O_CLOEXEC) == -1)
+        {
+            throw RuntimeActionExecutionError(std::string("Failed to create pipe: ") + strerror(errno));
+        }
+        SpawnOptions options;
+        options.stdoutFd = pipefd[1];
+        options.stderrFd = pipefd[1];
+        options.pathCache = pathCache;
+        options.newProcessGroup = true;
+        std::cout.flush();
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        ProcessId pid;
+        try
+        {
+            pid = spawnProcess(command.program, command.arguments, options);
+        }
+        catch (RuntimeActionExecutionError const &e)
+        {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            std::cerr << e.what() << std::endl;
+            return getSpawnFailureResult();
+        }
+        close(pipefd[1]);
+
+        int outputFd = pipefd[0];
+        int pidFd = openPidFd(pid);
+        // limits that don't fit into the clock are the same as no limit
+        std::chrono::steady_clock::time_point deadline = timeout < std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::time_point::max() - startTime)
+                                                             ? startTime + timeout
+                                                             : std::chrono::steady_clock::time_point::max();
+        std::optional<ProcessResult> result;
+        bool terminated = false;
+        bool killed = false;
+        auto collectExit = [&]()
+        {
+            int status = 0;
+            rusage usage{};
+            if (!result.has_value() && wait4((pid_t)pid, &status, WNOHANG, &usage) == (pid_t)pid)
+            {
+                result = makeProcessResult(status, usage, startTime);
+                // exit after our own signal means that the process didn't finish in time
+                if (terminated)
+                {
+                    result->exitCode = TimedOutExitCode;
+                    result->timedOut = true;
+                }
+            }
+        };
+        std::vector<char> buffer(ForwardBufferSize);
+        // output can be held open by children of the process, so we keep reading until it's closed or the group is killed
+        while (!result.has_value() || (outputFd != -1 && !killed))
+        {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (now >= deadline && !killed)
+            {
+                // process might have finished right before the deadline
+                collectExit();
+                // negative pid sends the signal to every process in the group
+                kill(-(pid_t)pid, terminated ? SIGKILL : SIGTERM);
+                killed = terminated;
+                terminated = true;
+                deadline = now + TerminationGracePeriod;
+                continue;
+            }
+            // poll takes an int, so waits longer than about 24 days are split into several polls
+            int waitMs = killed ? -1 : (int)std::min<int64_t>(std::chrono::ceil<std::chrono::milliseconds>(deadline - now).count(), INT_MAX);
+            if (pidFd == -1 && !result.has_value())
+            {
+                // without pidfd the only way to notice the exit is to keep checking
+                waitMs = waitMs == -1 ? 10 : std::min(waitMs, 10);
+            }
+            std::vector<pollfd> fds;
+            if (outputFd != -1)
+            {
+                fds.push_back(pollfd{.fd = outputFd, .events = POLLIN});
+            }
+            if (pidFd != -1 && !result.has_value())
+            {
+                fds.push_back(pollfd{.fd = pidFd, .events = POLLIN});
+            }
+            if (poll(fds.data(), fds.size(), waitMs) == -1 && errno != EINTR)
+            {
+                throw RuntimeActionExecutionError(std::string("Failed to wait for process: ") + strerror(errno));
+            }
+            if (outputFd != -1 && fds[0].revents != 0)
+            {
+                ssize_t count = read(outputFd, buffer.data(), buffer.size());
+                if (count > 0)
+                {
+                    writeAll(STDOUT_FILENO, buffer.data(), count);
+                }
+                else if (count == 0 || errno != EINTR)
+                {
+                    close(outputFd);
+                    outputFd = -1;
+                }
+            }
+            collectExit();
+        }
+        if (outputFd != -1)
+        {
+            close(outputFd);
+        }
+        if (pidFd != -1)
+        {
+            close(pidFd);
+        }
+        return result.value();
+    }
+
+    /// @brief Events stored in epoll use lowest bit to tell apart output and exit events
+    static uint64_t encodeEvent(int64_t handle, bool exitEvent) { return ((uint64_t)handle << 1) | (exitEvent ? 1 : 0); }
+
+    int64_t ProcessManager::startBackground(Command const &command, CommandPathCache *pathCache)
+    {
+        if (m_epollFd == -1)
+        {
+            m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (m_epollFd == -1)
+            {
+                throw RuntimeActionExecutionError(std::string("Failed to create event loop: ") + strerror(errno));
+            }
+            m_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (m_wakeFd == -1)
+            {
+                close(m_epollFd);
+                m_epollFd = -1;
+                throw RuntimeActionExecutionError(std::string("Failed to create event loop: ") + strerror(errno));
+            }
+            // handles start at 1, so 0 never belongs to a process
+            epoll_event wakeEvent{.events = EPOLLIN, .data = {.u64 = 0}};
+            epoll_ctl(m_epollFd, EPOLL_CTL_ADD, m_wakeFd, &wakeEvent);
+            m_eventLoop = std::thread(&ProcessManager::runEventLoop, this);
+        }
+        int pipefd[2];
+        if (pipe2(pipefd, O_CLOEXEC) == -1)
+        {
+            throw RuntimeActionExecutionError(std::string("Failed to create pipe: ") + strerror(errno));
+        }
+        SpawnOptions options;
+        options.stdoutFd = pipefd[1];
+        options.stderrFd = pipefd[1];
+        options.pathCache = pathCache;
+        ProcessId pid;
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        try
+        {
+            pid = spawnProcess(command.program, command.arguments, options);
+        }
+        catch (RuntimeActionExecutionError const &e)
+        {
+            close(pipefd[0]);
+            close(pipefd[1]);
+            throw;
+        }
+        close(pipefd[1]);
+        fcntl(pipefd[0], F_SETFL, fcntl(pipefd[0], F_GETFL) | O_NONBLOCK);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        int64_t handle = m_nextHandle++;
+        BackgroundProcess &process = m_processes[handle];
+        process.pid = pid;
+        process.program = command.program;
+        process.startTime = startTime;
+        process.outputFd = pipefd[0];
+        process.pidFd = openPidFd(pid);
+
+        epoll_event event{.events = EPOLLIN, .data = {.u64 = encodeEvent(handle, false)}};
+        epoll_ctl(m_epollFd, EPOLL_CTL_ADD, process.outputFd, &event);
+        if (process.pidFd != -1)
+        {
+            event.data.u64 = encodeEvent(handle, true);
+            epoll_ctl(m_epollFd, EPOLL_CTL_ADD, process.pidFd, &event);
+        }
+        return handle;
+    }
+
+    std::optional<ProcessResult> ProcessManager::poll(int64_t handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return getProcess(handle).result;
+    }
+
+    ProcessResult ProcessManager::wait(int64_t handle)
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        BackgroundProcess &process = getProcess(handle);
+        m_finished.wait(lock, [&process]()
+                        { return process.result.has_value(); });
+        ProcessResult result = process.result.value();
+        m_processes.erase(handle);
+        return result;
+    }
+
+    std::string const &ProcessManager::getProgram(int64_t handle)
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return getProcess(handle).program;
+    }
+
+    bool ProcessManager::isEmpty()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_processes.empty();
+    }
+
+    ProcessManager::~ProcessManager()
+    {
+        if (m_epollFd == -1)
+        {
+            return;
+        }
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            // output keeps being printed by the event loop while processes are stopping
+            for (std::pair<const int64_t, BackgroundProcess> &process : m_processes)
+            {
+                if (!process.second.result.has_value())
+                {
+                    kill((pid_t)process.second.pid, SIGTERM);
+                }
+            }
+            if (!waitForAll(lock, std::chrono::steady_clock::now() + TerminationGracePeriod))
+            {
+                for (std::pair<const int64_t, BackgroundProcess> &process : m_processes)
+                {
+                    if (!process.second.result.has_value())
+                    {
+                        kill((pid_t)process.second.pid, SIGKILL);
+                    }
+                }
+                waitForAll(lock, std::chrono::steady_clock::time_point::max());
+            }
+            m_stopping = true;
+        }
+        uint64_t wake = 1;
+        write(m_wakeFd, &wake, sizeof(wake));
+        m_eventLoop.join();
+        close(m_wakeFd);
+        close(m_epollFd);
+    }
+
+    ProcessManager::BackgroundProcess &ProcessManager::getProcess(int64_t handle)
+    {
+        if (std::map<int64_t, BackgroundProcess>::iterator it = m_processes.find(handle); it != m_processes.end())
+        {
+            return it->second;
+        }
+        throw RuntimeActionExecutionError("No running process with handle " + std::to_string(handle));
+    }
+
+    bool ProcessManager::waitForAll(std::unique_lock<std::mutex> &lock, std::chrono::steady_clock::time_point deadline)
+    {
+        return m_finished.wait_until(lock, deadline, [this]()
+                                     { return std::all_of(m_processes.begin(), m_processes.end(), [](std::pair<const int64_t, BackgroundProcess> const &process)
+                                                          { return process.second.result.has_value(); }); });
+    }
+
+    void ProcessManager::runEventLoop()
+    {
+        epoll_event events[32];
+        while (true)
+        {
+            bool polling;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if (m_stopping)
+                {
+                    return;
+                }
+                polling = std::any_of(m_processes.begin(), m_processes.end(), [](std::pair<const int64_t, BackgroundProcess> const &process)
+                                      { return process.second.pidFd == -1 && !process.second.result.has_value(); });
+            }
+            // without pidfd the only way to notice the exit is to keep checking
+            int count = epoll_wait(m_epollFd, events, 32, polling ? 10 : -1);
+            if (count == -1 && errno != EINTR)
+            {
+                std::cerr << "Failed to wait for process events: " << strerror(errno) << std::endl;
+                return;
+            }
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (int i = 0; i < count; i++)
+            {
+                processEvent(events[i].data.u64);
+            }
+            for (std::pair<const int64_t, BackgroundProcess> &process : m_processes)
+            {
+                if (process.second.pidFd == -1 && !process.second.result.has_value())
+                {
+                    checkExited(process.second);
+                }
+            }
+            m_finished.notify_all();
+        }
+    }
+
+    void ProcessManager::processEvent(uint64_t event)
+    {
+        if (event == 0)
+        {
+            uint64_t ignored;
+            read(m_wakeFd, &ignored, sizeof(ignored));
+            return;
+        }
+        std::map<int64_t, BackgroundProcess>::iterator it = m_processes.find(event >> 1);
+        if (it == m_processes.end() || it->second.result.has_value())
+        {
+            return;
+        }
+        if (event & 1)
+        {
+            checkExited(it->second);
+        }
+        else if (!readOutput(it->second))
+        {
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, it->second.outputFd, nullptr);
+            close(it->second.outputFd);
+            it->second.outputFd = -1;
+            // without pidfd closed output is the best hint we have that the process is done
+            if (it->second.pidFd == -1)
+            {
+                checkExited(it->second);
+            }
+        }
+    }
+
+    bool ProcessManager::readOutput(BackgroundProcess &process)
+    {
+        char buffer[ForwardBufferSize];
+        while (true)
+        {
+            ssize_t count = read(process.outputFd, buffer, sizeof(buffer));
+            if (count == -1 && errno == EINTR)
+            {
+                continue;
+            }
+            if (count <= 0)
+            {
+                bool finished = count == 0 || (errno != EAGAIN && errno != EWOULDBLOCK);
+                if (finished && !process.pendingLine.empty())
+                {
+                    std::cout.flush();
+                    writeAll(STDOUT_FILENO, process.pendingLine.data(), process.pendingLine.size());
+                    process.pendingLine.clear();
+                }
+                return !finished;
+            }
+            // only print whole lines so that output of different processes doesn't get mixed in the middle of the line
+            process.pendingLine.append(buffer, count);
+            size_t lastLineEnd = process.pendingLine.rfind('\n');
+            if (lastLineEnd != std::string::npos)
+            {
+                std::cout.flush();
+                writeAll(STDOUT_FILENO, process.pendingLine.data(), lastLineEnd + 1);
+                process.pendingLine.erase(0, lastLineEnd + 1);
+            }
+        }
+    }
+
+    void ProcessManager::checkExited(BackgroundProcess &process)
+    {
+        int status = 0;
+        rusage usage{};
+        pid_t result = wait4((pid_t)process.pid, &status, WNOHANG, &usage);
+        if (result == 0 || (result == -1 && errno == EINTR))
+        {
+            return;
+        }
+        if (process.outputFd != -1)
+        {
+            // process might have left some output that we haven't read yet
+            readOutput(process);
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, process.outputFd, nullptr);
+            close(process.outputFd);
+            process.outputFd = -1;
+            if (!process.pendingLine.empty())
+            {
+                std::cout.flush();
+                writeAll(STDOUT_FILENO, process.pendingLine.data(), process.pendingLine.size());
+                process.pendingLine.clear();
+            }
+        }
+        if (process.pidFd != -1)
+        {
+            epoll_ctl(m_epollFd, EPOLL_CTL_DEL, process.pidFd, nullptr);
+            close(process.pidFd);
+            process.pidFd = -1;
+        }
+        process.result = result == -1 ? getSpawnFailureResult() : makeProcessResult(status, usage, process.startTime);
+    }
+
+    /// @brief Write into the pipe without getting killed by SIGPIPE if the reader is gone. SIGPIPE is blocked only for the duration of the write,
+    /// so that children still get the default behaviour and signal that was raised by this write is discarded afterwards
+    /// @return False if write failed
+    static bool writeAllWithoutSigpipe(int fd, const char *data, size_t size)
+    {
+        sigset_t pipeSignal;
+        sigset_t previousMask;
+        sigemptyset(&pipeSignal);
+        sigaddset(&pipeSignal, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &pipeSignal, &previousMask);
+        bool written = writeAll(fd, data, size);
+        if (!written && errno == EPIPE)
+        {
+            timespec noWait{};
+            sigtimedwait(&pipeSignal, nullptr, &noWait);
+        }
+        pthread_sigmask(SIG_SETMASK, &previousMask, nullptr);
+        return written;
+    }
+
+    int64_t CoprocessManager::open(Command const &command, CommandPathCache *pathCache)
+    {
+        int inputPipe[2];
+        int outputPipe[2];
+        if (pipe2(inputPipe, O_CLOEXEC) == -1)
+        {
+            throw RuntimeActionExecutionError(std::string("Failed to create pipe: ") + strerror(errno));
+        }
+        if (pipe2(outputPipe, O_CLOEXEC) == -1)
+        {
+            ::close(inputPipe[0]);
+            ::close(inputPipe[1]);
+            throw RuntimeActionExecutionError(std::string("Failed to create pipe: ") + strerror(errno));
+        }
+        SpawnOptions options;
+        options.stdinFd = inputPipe[0];
+        options.stdoutFd = outputPipe[1];
+        options.pathCache = pathCache;
+        std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        ProcessId pid;
+        try
+        {
+            pid = spawnProcess(command.program, command.arguments, options);
+        }
+        catch (RuntimeActionExecutionError const &e)
+        {
+            for (int fd : {inputPipe[0], inputPipe[1], outputPipe[0], outputPipe[1]})
+            {
+                ::close(fd);
+            }
+            throw;
+        }
+        ::close(inputPipe[0]);
+        ::close(outputPipe[1]);
+        int64_t handle = m_nextHandle++;
+        m_coprocesses[handle] = Coprocess{.pid = pid,
+                                          .program = command.program,
+                                          .startTime = startTime,
+                                          .inputFd = inputPipe[1],
+                                          .outputFd = outputPipe[0]};
+        return handle;
+    }
+
+    bool CoprocessManager::writeLine(int64_t handle, std::string_view line)
+    {
+        Coprocess &coprocess = getCoprocess(handle);
+        if (coprocess.inputFd == -1)
+        {
+            return false;
+        }
+        std::string data(line);
+        if (data.empty() || data.back() != '\n')
+        {
+            data.push_back('\n');
+        }
+        return writeAllWithoutSigpipe(coprocess.inputFd, data.data(), data.size());
+    }
+
+    std::optional<std::string> CoprocessManager::readLine(int64_t handle)
+    {
+        Coprocess &coprocess = getCoprocess(handle);
+        // lines that are already in the buffer are returned without reading more
+        size_t searchStart = 0;
+        while (true)
+        {
+            size_t lineEnd = coprocess.buffer.find('\n', searchStart);
+            if (lineEnd != std::string::npos)
+            {
+                std::string line = coprocess.buffer.substr(0, lineEnd);
+                coprocess.buffer.erase(0, lineEnd + 1);
+                return line;
+            }
+            searchStart = coprocess.buffer.size();
+            if (coprocess.outputFd == -1)
+            {
+                break;
+            }
+            char chunk[ForwardBufferSize];
+            ssize_t count = read(coprocess.outputFd, chunk, sizeof(chunk));
+            if (count > 0)
+            {
+                coprocess.buffer.append(chunk, count);
+            }
+            else if (count == 0 || errno != EINTR)
+            {
+                ::close(coprocess.outputFd);
+                coprocess.outputFd = -1;
+            }
+        }
+        if (coprocess.buffer.empty())
+        {
+            return {};
+        }
+        // last line of the output doesn't have to end with a new line
+        std::string line = std::move(coprocess.buffer);
+        coprocess.buffer.clear();
+        return line;
+    }
+
+    ProcessResult CoprocessManager::close(int64_t handle)
+    {
+        Coprocess &coprocess = getCoprocess(handle);
+        // most programs that serve requests from stdin exit once input ends
+        if (coprocess.inputFd != -1)
+        {
+            ::close(coprocess.inputFd);
+        }
+        if (coprocess.outputFd != -1)
+        {
+            ::close(coprocess.outputFd);
+        }
+        ProcessId pid = coprocess.pid;
+        std::chrono::steady_clock::time_point startTime = coprocess.startTime;
+        m_coprocesses.erase(handle);
+
+        if (!waitForExit(pid, TerminationGracePeriod))
+        {
+            return stopProcess(pid, startTime);
+        }
+        return waitForProcess(pid, startTime);
+    }
+
+    std::string const &CoprocessManager::getProgram(int64_t handle)
+    {
+        return getCoprocess(handle).program;
+    }
+
+    CoprocessManager::~CoprocessManager()
+    {
+        while (!m_coprocesses.empty())
+        {
+            int64_t handle = m_coprocesses.begin()->first;
+            try
+            {
+                close(handle);
+            }
+            catch (RuntimeActionExecutionError const &e)
+            {
+                std::cerr << e.what() << std::endl;
+                m_coprocesses.erase(handle);
+            }
+        }
+    }
+
+    CoprocessManager::Coprocess &CoprocessManager::getCoprocess(int64_t handle)
+    {
+        if (std::map<int64_t, Coprocess>::iterator it = m_coprocesses.find(handle); it != m_coprocesses.end())
+        {
+            return it->second;
+        }
+        throw RuntimeActionExecutionError("No coprocess with handle " + std::to_string(handle));
+    }
+} // namespace Pigeon::Process
+
+#else
+
+namespace Pigeon::Process
+{
+    std::string CommandPathCache::resolve(std::string const &program)
+    {
+        return program;
+    }
+
+    void CommandPathCache::forget(std::string const &program)
+    {
+        m_paths.erase(program);
+    }
+
+    void CommandPathCache::clear()
+    {
+        m_paths.clear();
+        m_hits = 0;
+        m_misses = 0;
+    }
+
+    ProcessId spawnProcess(std::string const &program, std::vector<std::string> const &arguments, SpawnOptions const &options)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    void forwardOutput(int fromFd, int toFd)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::string readOutput(int fd)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    bool readLines(int fd, std::function<bool(std::string_view line)> const &callback)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    void terminateProcess(ProcessId pid)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    ProcessResult waitForProcess(ProcessId pid, std::chrono::steady_clock::time_point startTime)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::vector<ProcessResult> runCommandsInParallel(std::vector<Command> const &commands, size_t maxJobs, CommandPathCache *pathCache)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::vector<ProcessResult> runPipeline(std::vector<Command> const &commands, CommandPathCache *pathCache)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    ProcessResult runWithTimeout(Command const &command, std::chrono::milliseconds timeout, CommandPathCache *pathCache)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    int64_t ProcessManager::startBackground(Command const &command, CommandPathCache *pathCache)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::optional<ProcessResult> ProcessManager::poll(int64_t handle)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    ProcessResult ProcessManager::wait(int64_t handle)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::string const &ProcessManager::getProgram(int64_t handle)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    bool ProcessManager::isEmpty()
+    {
+        return true;
+    }
+
+    ProcessManager::~ProcessManager() {}
+
+    int64_t CoprocessManager::open(Command const &command, CommandPathCache *pathCache)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    bool CoprocessManager::writeLine(int64_t handle, std::string_view line)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::optional<std::string> CoprocessManager::readLine(int64_t handle)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    ProcessResult CoprocessManager::close(int64_t handle)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    std::string const &CoprocessManager::getProgram(int64_t handle)
+    {
+        throw RuntimeActionExecutionError("Process spawning is not implemented for this platform");
+    }
+
+    CoprocessManager::~CoprocessManager() {}
+} // namespace Pigeon::Process
+
+#endif
+
+namespace Pigeon::Process
+{
+    ProcessResult getSpawnFailureResult()
+    {
+        return ProcessResult{.exitCode = 127};
+    }
+
+    void CommandStatistics::record(std::string const &program, ProcessResult const &result)
+    {
+        Totals &totals = m_totals[program];
+        totals.runs++;
+        if (result.exitCode != 0)
+        {
+            totals.failures++;
+        }
+        totals.wallTime += result.wallTime;
+        totals.userTime += result.userTime;
+        totals.systemTime += result.systemTime;
+        totals.maxResidentKb = std::max(totals.maxResidentKb, result.maxResidentKb);
+    }
+
+    void CommandStatistics::printReport(std::ostream &out) const
+    {
+        std::vector<std::pair<std::string, Totals>> sorted(m_totals.begin(), m_totals.end());
+        std::sort(sorted.begin(), sorted.end(), [](std::pair<std::string, Totals> const &a, std::pair<std::string, Totals> const &b)
+                  { return a.second.wallTime > b.second.wallTime; });
+        auto toMs = [](std::chrono::microseconds time)
+        { return std::to_string(time.count() / 1000) + "." + std::to_string(time.count() % 1000 / 100); };
+        out << "command\truns\tfailed\twall ms\tuser ms\tsys ms\tmax rss kb" << std::endl;
+        for (std::pair<std::string, Totals> const &entry : sorted)
+        {
+            out << entry.first << "\t"
+                << entry.second.runs << "\t"
+                << entry.second.failures << "\t"
+                << toMs(entry.second.wallTime) << "\t"
+                << toMs(entry.second.userTime) << "\t"
+                << toMs(entry.second.systemTime) << "\t"
+                << entry.second.maxResidentKb << std::endl;
+        }
+    }
+} // namespace Pigeon::Process
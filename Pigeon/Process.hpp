@@ -0,0 +1,353 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+#include <chrono>
+#include <ostream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace Pigeon::Process
+{
+    /// @brief Id of the process in the system, on unix systems this is the pid
+    using ProcessId = int64_t;
+
+    /// @brief Remembers where programs were found in PATH, similar to the `hash` builtin of the shell, so that directories in PATH are not searched on every call.
+    /// Cache is cleared automatically when PATH changes
+    class CommandPathCache
+    {
+    public:
+        explicit CommandPathCache() = default;
+
+        /// @brief Find full path to the program
+        /// @param program Name of the program
+        /// @return Full path to the program or unchanged name if program name already contains a path or no program was found
+        std::string resolve(std::string const &program);
+
+        /// @brief Remove program from the cache, used when program is no longer at the remembered location
+        /// @param program Name of the program
+        void forget(std::string const &program);
+
+        void clear();
+
+        /// @brief How many times program was found in the cache
+        size_t getHitCount() const { return m_hits; }
+
+        /// @brief How many times PATH had to be searched
+        size_t getMissCount() const { return m_misses; }
+
+        size_t getEntryCount() const { return m_paths.size(); }
+
+    private:
+        /// @brief Value of PATH used to fill the cache
+        std::string m_pathVariable;
+        std::unordered_map<std::string, std::string> m_paths;
+        size_t m_hits = 0;
+        size_t m_misses = 0;
+    };
+
+    /// @brief File that should be opened in the child process in place of one of the standard streams
+    struct FileRedirection
+    {
+        /// @brief Which descriptor of the child will refer to the file, 0 for stdin, 1 for stdout and 2 for stderr
+        int fd;
+        std::string path;
+        /// @brief Flags passed to `open`, such as O_APPEND
+        int flags;
+    };
+
+    /// @brief Describes how standard streams of the new process should be set up
+    struct SpawnOptions
+    {
+        /// @brief Descriptor that will become stdin of the child or -1 to share the one used by interpreter
+        int stdinFd = -1;
+        /// @brief Descriptor that will become stdout of the child or -1 to share the one used by interpreter
+        int stdoutFd = -1;
+        /// @brief Descriptor that will become stderr of the child or -1 to share the one used by interpreter
+        int stderrFd = -1;
+        /// @brief Descriptors that belong to the interpreter and should not be left open in the child, such as the other end of the pipe
+        std::vector<int> closeFds;
+        /// @brief Files opened in the child after descriptors above are set up. These replace the descriptors above
+        std::vector<FileRedirection> files;
+        /// @brief Make stderr of the child refer to the same thing as stdout after all other redirections are done, unless stderr was redirected to a file
+        bool errorToOutput = false;
+        /// @brief Cache used to find the program or null to let the system search PATH
+        CommandPathCache *pathCache = nullptr;
+        /// @brief Start the process in a new process group, so that it can be stopped together with everything it starts
+        bool newProcessGroup = false;
+    };
+
+    /// @brief How process has finished and how much resources it used
+    struct ProcessResult
+    {
+        /// @brief Exit code of the process. For processes killed by a signal this is 128 + signal number, same as shell reports
+        int exitCode = 0;
+        /// @brief Signal that killed the process or 0 if process exited on its own
+        int signal = 0;
+        /// @brief Time between the start of the process and the moment interpreter noticed that it finished
+        std::chrono::microseconds wallTime{0};
+        /// @brief CPU time spent running the code of the process itself
+        std::chrono::microseconds userTime{0};
+        /// @brief CPU time spent in the kernel on behalf of the process
+        std::chrono::microseconds systemTime{0};
+        /// @brief Peak amount of memory used by the process in kilobytes
+        int64_t maxResidentKb = 0;
+        /// @brief True if process was stopped because it didn't finish in time, exit code is `TimedOutExitCode` in that case
+        bool timedOut = false;
+    };
+
+    /// @brief Exit code reported for processes that were stopped because they ran out of time. Programs can't exit with negative codes, so it can't be confused with a failure
+    static constexpr int TimedOutExitCode = -1;
+
+    /// @brief Running totals of resource usage for each program name, used to find out which commands take most of the time
+    class CommandStatistics
+    {
+    public:
+        explicit CommandStatistics() = default;
+
+        /// @brief Add finished process to the totals of the program
+        /// @param program Name of the program as it was written in the script
+        /// @param result Result of the process
+        void record(std::string const &program, ProcessResult const &result);
+
+        /// @brief Print table with totals of every program, programs that took most wall time come first
+        /// @param out Stream to print into
+        void printReport(std::ostream &out) const;
+
+        bool isEmpty() const { return m_totals.empty(); }
+
+    private:
+        struct Totals
+        {
+            size_t runs = 0;
+            /// @brief How many times program finished with non zero exit code
+            size_t failures = 0;
+            std::chrono::microseconds wallTime{0};
+            std::chrono::microseconds userTime{0};
+            std::chrono::microseconds systemTime{0};
+            /// @brief Largest peak memory among all runs
+            int64_t maxResidentKb = 0;
+        };
+        std::map<std::string, Totals> m_totals;
+    };
+
+    /// @brief Program name with all of its arguments
+    struct Command
+    {
+        std::string program;
+        std::vector<std::string> arguments;
+    };
+
+    /// @brief Start a new process without copying the interpreter memory. Uses posix_spawn which on linux is implemented via vfork semantics
+    /// @param program Name of the program, which will be looked up in PATH if it doesn't contain '/'
+    /// @param arguments Arguments passed to the program, not including the program name
+    /// @param options Description of how to connect the standard streams
+    /// @return Id of the started process. RuntimeActionExecutionError is thrown if process could not be started
+    ProcessId spawnProcess(std::string const &program, std::vector<std::string> const &arguments, SpawnOptions const &options);
+
+    /// @brief Copy everything from the descriptor into another one until the end of the input is reached.
+    /// Data is moved with splice when possible, so it doesn't pass through the user space at all, otherwise large buffer is used
+    /// @param fromFd Descriptor to read from, usually the read end of the pipe connected to the child
+    /// @param toFd Descriptor to write to
+    void forwardOutput(int fromFd, int toFd);
+
+    /// @brief Read everything from the descriptor until the end of the input into a single buffer
+    /// @param fd Descriptor to read from
+    /// @return All data that was read
+    std::string readOutput(int fd);
+
+    /// @brief Read input line by line using fixed size buffer, so memory use doesn't depend on the size of the input.
+    /// Lines longer than the buffer are split into several parts
+    /// @param fd Descriptor to read from
+    /// @param callback Function called for each line without the new line character. Reading stops once it returns false
+    /// @return True if the whole input was read and false if callback stopped reading early
+    bool readLines(int fd, std::function<bool(std::string_view line)> const &callback);
+
+    /// @brief Ask process to stop by sending SIGTERM
+    /// @param pid Id of the process
+    void terminateProcess(ProcessId pid);
+
+    /// @brief Block until process exits and collect its resource usage
+    /// @param pid Id of the process
+    /// @param startTime Moment right before the process was started, used to measure wall time
+    /// @return Exit code and resource usage of the process
+    ProcessResult waitForProcess(ProcessId pid, std::chrono::steady_clock::time_point startTime);
+
+    /// @brief Result used for commands that could not be started, same exit code as the one shell reports in that case
+    ProcessResult getSpawnFailureResult();
+
+    /// @brief Run all commands, keeping at most `maxJobs` of them running at the same time.
+    /// Output of each command is collected separately and written to stdout at once when command finishes, so output of different commands is never mixed
+    /// @param commands Commands to run, they are started in the same order
+    /// @param maxJobs Maximum amount of commands running at once
+    /// @return Result of each command in the same order as commands
+    /// @param pathCache Cache used to find programs or null to let the system search PATH
+    std::vector<ProcessResult> runCommandsInParallel(std::vector<Command> const &commands, size_t maxJobs, CommandPathCache *pathCache = nullptr);
+
+    /// @brief Run all commands at the same time, connecting stdout of each command to stdin of the next one.
+    /// Data between the commands is passed by the system, first command reads input of the interpreter and last one writes directly into interpreter output
+    /// @param commands Commands in the order of data flow
+    /// @return Result of each command in the same order as commands
+    /// @param pathCache Cache used to find programs or null to let the system search PATH
+    std::vector<ProcessResult> runPipeline(std::vector<Command> const &commands, CommandPathCache *pathCache = nullptr);
+
+    /// @brief Run command in its own process group, printing its output, and stop the whole group if command doesn't finish in time.
+    /// Group is first asked to stop with SIGTERM and if anything is still running after a short grace period it is killed with SIGKILL
+    /// @param command Command to run
+    /// @param timeout How long command is allowed to run
+    /// @param pathCache Cache used to find the program or null to let the system search PATH
+    /// @return Result of the command, with `timedOut` set if it had to be stopped
+    ProcessResult runWithTimeout(Command const &command, std::chrono::milliseconds timeout, CommandPathCache *pathCache = nullptr);
+
+    /// @brief Keeps track of commands running in the background and prints their output while the script is doing other work.
+    /// All running commands are handled by a single event loop running on its own thread, so output is read even while the script is busy
+    /// and commands never get stuck on a full pipe
+    class ProcessManager
+    {
+    public:
+        explicit ProcessManager() = default;
+
+        ProcessManager(ProcessManager const &) = delete;
+
+        /// @brief Start command without waiting for it to finish
+        /// @param command Command to run
+        /// @param pathCache Cache used to find the program or null to let the system search PATH
+        /// @return Handle used to refer to the process in other calls
+        int64_t startBackground(Command const &command, CommandPathCache *pathCache = nullptr);
+
+        /// @brief Check if the process has finished without blocking
+        /// @param handle Handle returned by `startBackground`
+        /// @return Result of the process or None if process is still running
+        std::optional<ProcessResult> poll(int64_t handle);
+
+        /// @brief Block until process finishes. After this the handle is no longer valid
+        /// @param handle Handle returned by `startBackground`
+        /// @return Result of the process
+        ProcessResult wait(int64_t handle);
+
+        /// @brief Get name of the program running under the handle
+        /// @param handle Handle returned by `startBackground`
+        std::string const &getProgram(int64_t handle);
+
+        /// @brief Check if there are no processes that were not waited for
+        bool isEmpty();
+
+        /// @brief Stops processes that are still running, first with SIGTERM and if they don't exit in time with SIGKILL
+        ~ProcessManager();
+
+    private:
+        struct BackgroundProcess
+        {
+            ProcessId pid;
+            std::string program;
+            std::chrono::steady_clock::time_point startTime;
+            /// @brief Read end of the pipe connected to stdout and stderr of the process or -1 once it's closed
+            int outputFd;
+            /// @brief Descriptor that becomes readable when process exits or -1 if system doesn't support pidfd
+            int pidFd;
+            /// @brief Last line of the output that is not finished yet
+            std::string pendingLine;
+            std::optional<ProcessResult> result;
+        };
+
+        /// @brief Wait for events from running processes and handle them until the manager is destroyed. Runs on its own thread
+        void runEventLoop();
+
+        /// @brief Handle the event of one of the processes, must be called with the mutex locked
+        /// @param event Data of the event as it was registered in epoll
+        void processEvent(uint64_t event);
+
+        /// @brief Block until every process has a result or the deadline passes
+        /// @return True if all processes have finished
+        bool waitForAll(std::unique_lock<std::mutex> &lock, std::chrono::steady_clock::time_point deadline);
+
+        /// @brief Read all available output of the process and print all finished lines
+        /// @return False if output has ended
+        bool readOutput(BackgroundProcess &process);
+
+        /// @brief Check if the process has exited and finish up if it has
+        void checkExited(BackgroundProcess &process);
+
+        BackgroundProcess &getProcess(int64_t handle);
+
+        /// @brief Protects processes, since the event loop updates them from its own thread
+        std::mutex m_mutex;
+        /// @brief Signalled by the event loop whenever a process finishes
+        std::condition_variable m_finished;
+        std::map<int64_t, BackgroundProcess> m_processes;
+        int64_t m_nextHandle = 1;
+        int m_epollFd = -1;
+        /// @brief Descriptor used to wake the event loop up when it has to stop
+        int m_wakeFd = -1;
+        bool m_stopping = false;
+        std::thread m_eventLoop;
+    };
+
+    /// @brief Keeps long running helper programs that receive requests on stdin and answer on stdout, so that a program can be started once and used many times.
+    /// Standard error of coprocesses is shared with the interpreter
+    class CoprocessManager
+    {
+    public:
+        explicit CoprocessManager() = default;
+
+        CoprocessManager(CoprocessManager const &) = delete;
+
+        /// @brief Start the program with stdin and stdout connected to the interpreter
+        /// @param command Command to run
+        /// @param pathCache Cache used to find the program or null to let the system search PATH
+        /// @return Handle used to refer to the coprocess in other calls
+        int64_t open(Command const &command, CommandPathCache *pathCache = nullptr);
+
+        /// @brief Write a line into stdin of the coprocess. New line character is added if line doesn't end with one
+        /// @param handle Handle returned by `open`
+        /// @param line Line to write
+        /// @return False if coprocess is no longer reading its input
+        bool writeLine(int64_t handle, std::string_view line);
+
+        /// @brief Block until coprocess writes a whole line
+        /// @param handle Handle returned by `open`
+        /// @return Line without the new line character or None if coprocess has closed its output
+        std::optional<std::string> readLine(int64_t handle);
+
+        /// @brief Close input of the coprocess and wait for it to exit. Coprocess that doesn't exit on its own after a grace period is sent SIGTERM and if it is still running after another grace period SIGKILL.
+        /// After this the handle is no longer valid
+        /// @param handle Handle returned by `open`
+        /// @return Result of the coprocess
+        ProcessResult close(int64_t handle);
+
+        /// @brief Get name of the program running under the handle
+        /// @param handle Handle returned by `open`
+        std::string const &getProgram(int64_t handle);
+
+        /// @brief Check if there are no coprocesses that were not closed
+        bool isEmpty() const { return m_coprocesses.empty(); }
+
+        /// @brief Closes all coprocesses that are still open
+        ~CoprocessManager();
+
+    private:
+        struct Coprocess
+        {
+            ProcessId pid;
+            std::string program;
+            std::chrono::steady_clock::time_point startTime;
+            /// @brief Write end of the pipe connected to stdin of the coprocess
+            int inputFd;
+            /// @brief Read end of the pipe connected to stdout of the coprocess
+            int outputFd;
+            /// @brief Output that was read but not returned yet because the line is not finished
+            std::string buffer;
+        };
+
+        Coprocess &getCoprocess(int64_t handle);
+
+        std::map<int64_t, Coprocess> m_coprocesses;
+        int64_t m_nextHandle = 1;
+    };
+} // namespace Pigeon::Process
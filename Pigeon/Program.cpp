@@ -0,0 +1,26 @@
+#include "Program.hpp"
+#include "Action.hpp"
+#include "Parser.hpp"
+
+Program::Program(std::string code) : m_code(std::move(code))
+{
+}
+
+void Program::parse()
+{
+    std::string::const_iterator start = m_code.begin();
+    std::vector<std::unique_ptr<Action>> actions = Pigeon::Parser::parseTopLevelDeclarations(start, m_code.end());
+    m_root = std::make_unique<SequenceAction>(m_code.begin(), std::move(actions));
+}
+
+Value Program::execute(State &state) const
+{
+    if (m_root == nullptr)
+    {
+        throw RuntimeActionExecutionError("Program has to be parsed before it can be executed");
+    }
+    state.addProgram(shared_from_this());
+    return m_root->execute(state);
+}
+
+Program::~Program() = default;
@@ -0,0 +1,35 @@
+#pragma once
+#include <string>
+#include <memory>
+#include "Value.hpp"
+
+class Action;
+class State;
+
+/// @brief Parsed script. Once parsed the program never changes, so it can be executed by several states at once, including states on different threads
+class Program : public std::enable_shared_from_this<Program>
+{
+public:
+    /// @brief Create program from the code. Code has to be parsed with `parse` before the program can be executed
+    /// @param code Code of the program, which is kept by the program since parsed actions point into it
+    explicit Program(std::string code);
+
+    Program(Program const &) = delete;
+
+    /// @brief Parse the code of the program. On failure ParsingError is thrown, which points into the code returned by `getCode`
+    void parse();
+
+    std::string const &getCode() const { return m_code; }
+
+    /// @brief Execute top level of the program in the state, which also declares its functions.
+    /// The state keeps the program alive for as long as functions of the program can be called from it
+    /// @param state
+    /// @return Value of the last top level action
+    Value execute(State &state) const;
+
+    ~Program();
+
+private:
+    std::string m_code;
+    std::unique_ptr<Action> m_root;
+};
@@ -0,0 +1,234 @@
+#include "Regex.hpp"
+#include "Error.hpp"
+#include <cctype>
+#include <cstring>
+#if defined(USE_RE2)
+#include <re2/re2.h>
+#endif
+
+namespace Pigeon
+{
+    /// @brief Get the literal text at the start of the pattern, which every match has to start with
+    static std::string getLiteralPrefix(std::string const &pattern)
+    {
+        // each alternative can start with different text
+        if (pattern.find('|') != std::string::npos)
+        {
+            return {};
+        }
+        std::string prefix;
+        for (size_t i = 0; i < pattern.size();)
+        {
+            char literal = pattern[i];
+            size_t next = i + 1;
+            if (literal == '\\')
+            {
+                // escaped letters and digits are classes or back references, escaped punctuation is the character itself
+                if (next >= pattern.size() || std::isalnum((unsigned char)pattern[next]))
+                {
+                    break;
+                }
+                literal = pattern[next++];
+            }
+            else if (std::strchr("^$.*+?()[]{}", literal) != nullptr)
+            {
+                break;
+            }
+            if (next < pattern.size() && std::strchr("*?{", pattern[next]) != nullptr)
+            {
+                // character can be missing from the match
+                break;
+            }
+            prefix += literal;
+            if (next < pattern.size() && pattern[next] == '+')
+            {
+                break;
+            }
+            i = next;
+        }
+        return prefix;
+    }
+
+    Regex::Regex(std::string const &pattern) : m_pattern(pattern), m_prefix(getLiteralPrefix(pattern))
+    {
+#if defined(USE_RE2)
+        RE2::Options options;
+        options.set_log_errors(false);
+        m_re2 = std::make_unique<RE2>(pattern, options);
+        if (m_re2->ok())
+        {
+            return;
+        }
+        // back references, lookahead and such are only supported by std::regex
+        m_re2.reset();
+#endif
+        try
+        {
+            m_regex = std::regex(pattern, std::regex::ECMAScript | std::regex::optimize);
+        }
+        catch (std::regex_error const &e)
+        {
+            throw RuntimeActionExecutionError("Invalid regular expression '" + pattern + "': " + e.what());
+        }
+    }
+
+    void Regex::checkBacktrackingSize(std::string_view text) const
+    {
+        if (text.size() > MaxBacktrackingTextSize)
+        {
+            throw RuntimeActionExecutionError("Regular expression '" + m_pattern + "' can only be used on text of up to " +
+                                              std::to_string(MaxBacktrackingTextSize) + " characters, but text has " + std::to_string(text.size()));
+        }
+    }
+
+    bool Regex::runBacktracking(std::string_view text, size_t offset, bool whole, Match &result) const
+    {
+        checkBacktrackingSize(text);
+        std::cmatch groups;
+        if (whole)
+        {
+            if (!std::regex_match(text.data(), text.data() + text.size(), groups, m_regex))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            std::regex_constants::match_flag_type flags = offset > 0 ? std::regex_constants::match_prev_avail : std::regex_constants::match_default;
+            if (!std::regex_search(text.data() + offset, text.data() + text.size(), groups, m_regex, flags))
+            {
+                return false;
+            }
+        }
+        result.clear();
+        for (std::csub_match const &group : groups)
+        {
+            result.push_back(group.matched ? std::string_view(group.first, group.second - group.first) : std::string_view());
+        }
+        return true;
+    }
+
+    bool Regex::match(std::string_view text, Match &result) const
+    {
+        if (!text.starts_with(m_prefix))
+        {
+            return false;
+        }
+#if defined(USE_RE2)
+        if (m_re2)
+        {
+            std::vector<re2::StringPiece> groups(m_re2->NumberOfCapturingGroups() + 1);
+            if (!m_re2->Match(re2::StringPiece(text.data(), text.size()), 0, text.size(), RE2::ANCHOR_BOTH, groups.data(), (int)groups.size()))
+            {
+                return false;
+            }
+            result.assign(groups.begin(), groups.end());
+            return true;
+        }
+#endif
+        return runBacktracking(text, 0, true, result);
+    }
+
+    bool Regex::search(std::string_view text, size_t offset, Match &result) const
+    {
+        if (!m_prefix.empty())
+        {
+            // no match can start before the first occurrence of the prefix
+            offset = text.find(m_prefix, offset);
+            if (offset == std::string_view::npos)
+            {
+                return false;
+            }
+        }
+        if (offset > text.size())
+        {
+            return false;
+        }
+#if defined(USE_RE2)
+        if (m_re2)
+        {
+            // whole text is passed, so anchors see the text before the offset
+            std::vector<re2::StringPiece> groups(m_re2->NumberOfCapturingGroups() + 1);
+            if (!m_re2->Match(re2::StringPiece(text.data(), text.size()), offset, text.size(), RE2::UNANCHORED, groups.data(), (int)groups.size()))
+            {
+                return false;
+            }
+            result.assign(groups.begin(), groups.end());
+            return true;
+        }
+#endif
+        return runBacktracking(text, offset, false, result);
+    }
+
+    void Regex::appendReplacement(std::string_view text, Match const &result, std::string_view replacement, std::string &output)
+    {
+        size_t start = result[0].data() - text.data();
+        size_t end = start + result[0].size();
+        for (size_t i = 0; i < replacement.size(); i++)
+        {
+            if (replacement[i] != '$' || i + 1 == replacement.size())
+            {
+                output += replacement[i];
+                continue;
+            }
+            char next = replacement[i + 1];
+            if (next == '$')
+            {
+                output += '$';
+            }
+            else if (next == '&')
+            {
+                output.append(result[0]);
+            }
+            else if (next == '`')
+            {
+                output.append(text.substr(0, start));
+            }
+            else if (next == '\'')
+            {
+                output.append(text.substr(end));
+            }
+            else if (std::isdigit((unsigned char)next))
+            {
+                size_t group = next - '0';
+                // two digits are used only if such group exists
+                size_t twoDigits = i + 2 < replacement.size() && std::isdigit((unsigned char)replacement[i + 2]) ? group * 10 + (replacement[i + 2] - '0') : 0;
+                if (twoDigits > 0 && twoDigits < result.size())
+                {
+                    group = twoDigits;
+                    i++;
+                }
+                if (group == 0 || group >= result.size())
+                {
+                    // not a group, so it's written as it is
+                    output.append(replacement.substr(i, 2));
+                }
+                else
+                {
+                    output.append(result[group]);
+                }
+            }
+            else
+            {
+                output += '$';
+                continue;
+            }
+            i++;
+        }
+    }
+
+    Regex::~Regex() = default;
+
+    Regex const &RegexCache::get(std::string const &pattern)
+    {
+        if (std::unordered_map<std::string, std::unique_ptr<Regex>>::iterator it = m_regexes.find(pattern); it != m_regexes.end())
+        {
+            return *it->second;
+        }
+        if (m_regexes.size() >= MaxSize)
+        {
+            m_regexes.clear();
+        }
+        return *m_regexes.emplace(pattern, std::make_unique<Regex>(pattern)).first->second;
+    }
+} // namespace Pigeon
@@ -0,0 +1,99 @@
+#pragma once
+#include <string>
+#include <string_view>
+#include <vector>
+#include <regex>
+#include <memory>
+#include <unordered_map>
+
+#if defined(USE_RE2)
+namespace re2
+{
+    class RE2;
+}
+#endif
+
+namespace Pigeon
+{
+    /// @brief Regular expression compiled once together with the literal text that every match starts with.
+    /// Text that doesn't contain the literal is rejected without running the regular expression.
+    /// Patterns are run by RE2 when it's available, which needs no recursion and takes time linear in the length of the text.
+    /// Patterns that RE2 doesn't support, such as back references and lookahead, and all patterns without RE2 are run by std::regex,
+    /// which recurses for every repeated character, so the length of the text is limited to keep it from running out of stack
+    class Regex
+    {
+    public:
+        /// @brief Longest text that patterns run by std::regex can be used on
+        static constexpr size_t MaxBacktrackingTextSize = 4096;
+
+        /// @brief Whole match followed by captured groups, as views into the text. Groups that didn't take part in the match have null data
+        using Match = std::vector<std::string_view>;
+
+        /// @brief Compile the pattern using ECMAScript syntax. RuntimeActionExecutionError is thrown if the pattern is not valid
+        /// @param pattern
+        explicit Regex(std::string const &pattern);
+
+        Regex(Regex const &) = delete;
+
+        /// @brief Check if the whole text matches.
+        /// RuntimeActionExecutionError is thrown if the text is too long for the pattern
+        /// @param text
+        /// @param result Whole match and captured groups, filled only if text matches
+        bool match(std::string_view text, Match &result) const;
+
+        /// @brief Find the first match that starts at or after the offset.
+        /// RuntimeActionExecutionError is thrown if the text is too long for the pattern
+        /// @param text
+        /// @param offset Offset in the text to start at, text before it is still used by anchors such as `\b`
+        /// @param result Whole match and captured groups, filled only if a match was found
+        bool search(std::string_view text, size_t offset, Match &result) const;
+
+        /// @brief Append replacement of the match to the output, where `$&` is the whole match, `$1` to `$99` are groups,
+        /// `` $` `` and `$'` are text before and after the match and `$$` is the `$` character, same as in JavaScript
+        /// @param text Text that was searched
+        /// @param result Match found in the text
+        /// @param replacement
+        /// @param output
+        static void appendReplacement(std::string_view text, Match const &result, std::string_view replacement, std::string &output);
+
+        /// @brief Literal text every match starts with, empty if the pattern starts with something else
+        std::string const &getPrefix() const { return m_prefix; }
+
+        ~Regex();
+
+    private:
+        /// @brief Check that std::regex can be used on the text without running out of stack
+        void checkBacktrackingSize(std::string_view text) const;
+
+        /// @brief Run std::regex and convert its results
+        bool runBacktracking(std::string_view text, size_t offset, bool whole, Match &result) const;
+
+        std::string m_pattern;
+#if defined(USE_RE2)
+        /// @brief Null if RE2 doesn't support the pattern
+        std::unique_ptr<re2::RE2> m_re2;
+#endif
+        std::regex m_regex;
+        std::string m_prefix;
+    };
+
+    /// @brief Regular expressions compiled by the state, so that patterns used in loops are only compiled once
+    class RegexCache
+    {
+    public:
+        /// @brief After this many patterns the cache is cleared, so generated patterns can't fill the memory
+        static constexpr size_t MaxSize = 256;
+
+        explicit RegexCache() = default;
+
+        /// @brief Get the compiled pattern, compiling it if it wasn't used before.
+        /// Reference is only valid until the next call, since the cache can be cleared
+        /// @param pattern
+        Regex const &get(std::string const &pattern);
+
+        void clear() { m_regexes.clear(); }
+
+    private:
+        std::unordered_map<std::string, std::unique_ptr<Regex>> m_regexes;
+    };
+} // namespace Pigeon
@@ -0,0 +1,28 @@
+#include "Sequence.hpp"
+#include "Array.hpp"
+
+SequenceNode::SequenceNode(ArrayNode *array, std::vector<SequenceStage> stages) : m_sourceType(SequenceSourceType::Array), m_array(array), m_stages(std::move(stages))
+{
+    m_array->increaseRefCount();
+}
+
+SequenceNode::SequenceNode(SequenceSourceType type, std::string const &path, std::vector<SequenceStage> stages) : m_sourceType(type), m_path(path), m_stages(std::move(stages))
+{
+}
+
+SequenceNode::SequenceNode(SequenceNode const &base, SequenceStage const &stage) : m_sourceType(base.m_sourceType), m_array(base.m_array), m_path(base.m_path), m_stages(base.m_stages)
+{
+    m_stages.push_back(stage);
+    if (m_array != nullptr)
+    {
+        m_array->increaseRefCount();
+    }
+}
+
+SequenceNode::~SequenceNode()
+{
+    if (m_array != nullptr)
+    {
+        m_array->decreaseRefCount();
+    }
+}
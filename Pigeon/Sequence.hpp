@@ -0,0 +1,80 @@
+#pragma once
+#include "Value.hpp"
+#include "Memory.hpp"
+#include <vector>
+#include <string>
+
+class ArrayNode;
+
+/// @brief Where elements of the lazy sequence come from
+enum class SequenceSourceType
+{
+    /// @brief Elements of the array
+    Array,
+    /// @brief Paths of entries in the directory
+    Directory,
+    /// @brief Lines of the file without the line break
+    FileLines,
+};
+
+/// @brief Kind of the step that is applied to elements of the lazy sequence
+enum class SequenceStageType
+{
+    /// @brief Element is replaced with the result of the function
+    Map,
+    /// @brief Element is dropped if the function returns null value
+    Filter,
+    /// @brief Only given number of elements pass, after that the sequence ends
+    Take,
+};
+
+struct SequenceStage
+{
+    SequenceStageType type;
+    /// @brief Function called for each element by map and filter stages
+    FunctionReference function = {};
+    /// @brief How many elements can pass through the take stage
+    size_t limit = 0;
+};
+
+/// @brief Sequence of values that are produced one at a time only when the sequence is iterated.
+/// Sequence is a description of the source and the stages elements go through, so it never changes once created and
+/// every iteration starts from the beginning of the source again
+class SequenceNode : public MemoryNode
+{
+public:
+    /// @brief Create sequence that goes over elements of the array
+    /// @param array Array to read, it is kept alive as long as the sequence exists
+    /// @param stages Steps applied to every element in order
+    explicit SequenceNode(ArrayNode *array, std::vector<SequenceStage> stages = {});
+
+    /// @brief Create sequence that reads the file system
+    /// @param type Either directory or file lines
+    /// @param path Path of the directory or file, it is only opened when sequence is iterated
+    /// @param stages Steps applied to every element in order
+    explicit SequenceNode(SequenceSourceType type, std::string const &path, std::vector<SequenceStage> stages = {});
+
+    /// @brief Create sequence that reads same source as the given one, with an extra stage after the existing ones
+    /// @param base
+    /// @param stage
+    explicit SequenceNode(SequenceNode const &base, SequenceStage const &stage);
+
+    SequenceSourceType getSourceType() const { return m_sourceType; }
+
+    /// @brief Get array that elements are read from
+    /// @return Array or nullptr if sequence reads the file system
+    ArrayNode *getArray() const { return m_array; }
+
+    /// @brief Get path of the directory or file that elements are read from. Only meaningful if there is no array
+    std::string const &getPath() const { return m_path; }
+
+    std::vector<SequenceStage> const &getStages() const { return m_stages; }
+
+    virtual ~SequenceNode();
+
+private:
+    SequenceSourceType m_sourceType;
+    ArrayNode *m_array = nullptr;
+    std::string m_path;
+    std::vector<SequenceStage> m_stages;
+};
@@ -31,4 +31,57 @@ static const std::map<std::string, StandardFunctionInfo> StandardFunctions = {
     {"chr", StandardFunctionInfo{.argumentCount = 1, .functionId = 15}},
     {"ord", StandardFunctionInfo{.argumentCount = 1, .functionId = 16}},
     {"print", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 17}},
-    {"exit", StandardFunctionInfo{.argumentCount = 1, .functionId = 18}}};
\ No newline at end of file
+    {"exit", StandardFunctionInfo{.argumentCount = 1, .functionId = 18}},
+    {"exec_parallel", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 19}},
+    {"pipeline", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 20}},
+    {"exec_async", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 21}},
+    {"exec_poll", StandardFunctionInfo{.argumentCount = 1, .functionId = 22}},
+    {"exec_wait", StandardFunctionInfo{.argumentCount = 1, .functionId = 23}},
+    {"exec_lines", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 24}},
+    {"exec_cache_stats", StandardFunctionInfo{.argumentCount = 0, .functionId = 25}},
+    {"exec_cache_clear", StandardFunctionInfo{.argumentCount = 0, .functionId = 26}},
+    {"exec_report", StandardFunctionInfo{.argumentCount = 0, .functionId = 27}},
+    {"exec_timeout", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 28}},
+    {"coproc_open", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 29}},
+    {"coproc_write", StandardFunctionInfo{.argumentCount = 2, .functionId = 30}},
+    {"coproc_read", StandardFunctionInfo{.argumentCount = 1, .functionId = 31}},
+    {"coproc_close", StandardFunctionInfo{.argumentCount = 1, .functionId = 32}},
+    {"make_dir", StandardFunctionInfo{.argumentCount = 1, .functionId = 33}},
+    {"copy_path", StandardFunctionInfo{.argumentCount = 2, .functionId = 34}},
+    {"move_path", StandardFunctionInfo{.argumentCount = 2, .functionId = 35}},
+    {"remove_path", StandardFunctionInfo{.argumentCount = 1, .functionId = 36}},
+    {"touch_file", StandardFunctionInfo{.argumentCount = 1, .functionId = 37}},
+    {"print_file", StandardFunctionInfo{.argumentCount = 1, .functionId = 38}},
+    {"copy_files", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 39}},
+    {"move_files", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 40}},
+    {"remove_paths", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 41}},
+    {"walk", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 42}},
+    {"stat_cache", StandardFunctionInfo{.argumentCount = 1, .functionId = 43}},
+    {"stat_invalidate", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 44}},
+    {"stat", StandardFunctionInfo{.argumentCount = 1, .functionId = 45}},
+    {"lazy", StandardFunctionInfo{.argumentCount = 1, .functionId = 46}},
+    {"iterdir", StandardFunctionInfo{.argumentCount = 1, .functionId = 47}},
+    {"take", StandardFunctionInfo{.argumentCount = 2, .functionId = 48}},
+    {"force", StandardFunctionInfo{.argumentCount = 1, .functionId = 49}},
+    {"each", StandardFunctionInfo{.argumentCount = 2, .functionId = 50}},
+    {"read_file", StandardFunctionInfo{.argumentCount = 1, .functionId = 51}},
+    {"lines", StandardFunctionInfo{.argumentCount = 1, .functionId = 52}},
+    {"file_open", StandardFunctionInfo{.argumentCount = 1, .functionId = 53}},
+    {"file_append", StandardFunctionInfo{.argumentCount = 1, .functionId = 54}},
+    {"file_write", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 55}},
+    {"file_flush", StandardFunctionInfo{.argumentCount = 1, .functionId = 56}},
+    {"file_close", StandardFunctionInfo{.argumentCount = 1, .functionId = 57}},
+    {"channel", StandardFunctionInfo{.argumentCount = 0, .functionId = 58}},
+    {"channel_send", StandardFunctionInfo{.argumentCount = 2, .functionId = 59}},
+    {"channel_receive", StandardFunctionInfo{.argumentCount = 1, .functionId = 60}},
+    {"channel_close", StandardFunctionInfo{.argumentCount = 1, .functionId = 61}},
+    {"isolate", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 62}},
+    {"isolate_join", StandardFunctionInfo{.argumentCount = 1, .functionId = 63}},
+    {"pmap", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 64}},
+    {"spawn", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 65}},
+    {"join", StandardFunctionInfo{.argumentCount = 1, .functionId = 66}},
+    {"glob", StandardFunctionInfo{.argumentCount = (size_t)-1, .functionId = 67}},
+    {"match", StandardFunctionInfo{.argumentCount = 2, .functionId = 68}},
+    {"search", StandardFunctionInfo{.argumentCount = 2, .functionId = 69}},
+    {"replace", StandardFunctionInfo{.argumentCount = 3, .functionId = 70}},
+    {"split", StandardFunctionInfo{.argumentCount = 2, .functionId = 71}}};
\ No newline at end of file
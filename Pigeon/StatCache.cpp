@@ -0,0 +1,112 @@
+#include "StatCache.hpp"
+#include <filesystem>
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+#include <sys/stat.h>
+#endif
+
+namespace Pigeon
+{
+    /// @brief Ask the system for metadata of the file
+    static FileStatus readStatus(std::string const &path)
+    {
+        FileStatus status;
+#if (defined(LINUX) || defined(__linux__) || defined(__CYGWIN__))
+        // single stat call answers everything, unlike separate std::filesystem calls for type, size and time
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+        {
+            return status;
+        }
+        status.type = S_ISREG(info.st_mode)   ? FileType::File
+                      : S_ISDIR(info.st_mode) ? FileType::Directory
+                                              : FileType::Other;
+        status.size = info.st_size;
+        status.modificationTime = info.st_mtime;
+#else
+        std::error_code error;
+        std::filesystem::file_status fileStatus = std::filesystem::status(path, error);
+        if (error || !std::filesystem::exists(fileStatus))
+        {
+            return status;
+        }
+        status.type = std::filesystem::is_regular_file(fileStatus) ? FileType::File
+                      : std::filesystem::is_directory(fileStatus)  ? FileType::Directory
+                                                                   : FileType::Other;
+        if (status.type == FileType::File)
+        {
+            status.size = std::filesystem::file_size(path, error);
+        }
+        std::filesystem::file_time_type time = std::filesystem::last_write_time(path, error);
+        status.modificationTime = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::clock_cast<std::chrono::system_clock>(time).time_since_epoch()).count();
+#endif
+        return status;
+    }
+
+    void StatCache::enable(std::optional<std::chrono::milliseconds> timeToLive)
+    {
+        m_enabled = true;
+        m_timeToLive = timeToLive;
+    }
+
+    void StatCache::disable()
+    {
+        m_enabled = false;
+        clear();
+    }
+
+    FileStatus StatCache::getStatus(std::string const &path)
+    {
+        if (!m_enabled)
+        {
+            return readStatus(path);
+        }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (std::unordered_map<std::string, Entry>::iterator it = m_entries.find(path); it != m_entries.end())
+        {
+            if (!m_timeToLive.has_value() || now - it->second.time < m_timeToLive.value())
+            {
+                return it->second.status;
+            }
+        }
+        FileStatus status = readStatus(path);
+        m_entries[path] = Entry{.status = status, .time = now};
+        return status;
+    }
+
+    void StatCache::invalidate(std::string const &path)
+    {
+        if (m_entries.empty())
+        {
+            return;
+        }
+        m_entries.erase(path);
+        // paths inside of a changed directory can be affected as well
+        std::string prefix = path.empty() || path.back() == '/' ? path : path + "/";
+        std::erase_if(m_entries, [&prefix](std::pair<const std::string, Entry> const &entry)
+                      { return entry.first.starts_with(prefix); });
+    }
+
+    void StatCache::invalidateParents(std::string const &path)
+    {
+        if (m_entries.empty())
+        {
+            return;
+        }
+        std::filesystem::path parent = std::filesystem::path(path).parent_path();
+        while (!parent.empty())
+        {
+            m_entries.erase(parent.string());
+            m_entries.erase(parent.string() + "/");
+            if (parent == parent.parent_path())
+            {
+                break;
+            }
+            parent = parent.parent_path();
+        }
+    }
+
+    void StatCache::clear()
+    {
+        m_entries.clear();
+    }
+} // namespace Pigeon
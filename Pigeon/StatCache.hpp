@@ -0,0 +1,71 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+
+namespace Pigeon
+{
+    /// @brief Kind of file that path refers to, after following symbolic links
+    enum class FileType
+    {
+        /// @brief Nothing exists at the path or it can't be accessed
+        None,
+        File,
+        Directory,
+        Other,
+    };
+
+    /// @brief Metadata of the file that scripts can ask for
+    struct FileStatus
+    {
+        FileType type = FileType::None;
+        uint64_t size = 0;
+        /// @brief Time of the last modification in seconds since unix epoch
+        int64_t modificationTime = 0;
+    };
+
+    /// @brief Remembers metadata of files so that checking the same path many times doesn't ask the system every time.
+    /// Cache is disabled by default, since files can be changed by other programs at any time
+    class StatCache
+    {
+    public:
+        explicit StatCache() = default;
+
+        /// @brief Enable the cache
+        /// @param timeToLive How long remembered metadata stays valid or None to keep it until it is invalidated
+        void enable(std::optional<std::chrono::milliseconds> timeToLive);
+
+        /// @brief Disable the cache and forget everything that was remembered
+        void disable();
+
+        bool isEnabled() const { return m_enabled; }
+
+        /// @brief Get metadata of the file, from the cache if it's enabled and has fresh entry for the path
+        /// @param path Path to the file
+        FileStatus getStatus(std::string const &path);
+
+        /// @brief Forget metadata of the path and everything inside of it, used when the path is changed by the interpreter
+        /// @param path Path that was changed
+        void invalidate(std::string const &path);
+
+        /// @brief Forget metadata of every directory the path is inside of, used when missing parents are created by the interpreter.
+        /// Unlike `invalidate` other paths inside of those directories are kept
+        /// @param path Path that was created
+        void invalidateParents(std::string const &path);
+
+        void clear();
+
+    private:
+        struct Entry
+        {
+            FileStatus status;
+            std::chrono::steady_clock::time_point time;
+        };
+
+        bool m_enabled = false;
+        std::optional<std::chrono::milliseconds> m_timeToLive;
+        std::unordered_map<std::string, Entry> m_entries;
+    };
+} // namespace Pigeon
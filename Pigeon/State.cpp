@@ -1,5 +1,6 @@
 #include "State.hpp"
 #include "Action.hpp"
+#include "Program.hpp"
 #include <algorithm>
 State::State()
 {
@@ -10,17 +11,98 @@ State::State(std::vector<NativeFunction> const &funcs) : m_standardFunctions(fun
 {
     m_variables.push_back({});
 }
+std::unique_ptr<State> State::createIsolatedState(State const &parent)
+{
+    std::unique_ptr<State> state = std::make_unique<State>(parent.m_standardFunctions);
+    // function bodies belong to the program, which is shared since it never changes after parsing
+    state->m_functionNames = parent.m_functionNames;
+    state->m_functions = parent.m_functions;
+    state->m_programs = parent.m_programs;
+    state->m_channels = parent.m_channels;
+    return state;
+}
+
+std::unique_ptr<State> State::createTaskState(std::shared_ptr<State const> const &taskTemplate)
+{
+    std::unique_ptr<State> state = createIsolatedState(*taskTemplate);
+    // functions are the same as in the template, so tasks spawned from this state can use it as well
+    state->m_taskTemplate = taskTemplate;
+    return state;
+}
+
+std::shared_ptr<State const> State::getTaskTemplate()
+{
+    if (m_taskTemplate == nullptr)
+    {
+        m_taskTemplate = createIsolatedState(*this);
+    }
+    return m_taskTemplate;
+}
+
+bool State::resetForTask()
+{
+    m_tasks.stopAll();
+    if (m_taskTemplate == nullptr || !m_processManager.isEmpty() || !m_coprocessManager.isEmpty() || !m_fileWriters.isEmpty() || !m_isolates.isEmpty())
+    {
+        return false;
+    }
+    // nothing created by the finished task can be referenced anymore, since its result was already copied out
+    m_variables.clear();
+    m_variables.push_back({});
+    freeAllObjects();
+    return true;
+}
+
+void State::addProgram(std::shared_ptr<Program const> program)
+{
+    // programs are only ever run again by isolates, which already share the list
+    if (std::find(m_programs.begin(), m_programs.end(), program) == m_programs.end())
+    {
+        m_programs.push_back(std::move(program));
+        m_taskTemplate.reset();
+    }
+}
+
 StringNode *State::createString(std::string const &base)
 {
     StringNode *node = new StringNode(base);
-    m_root.pushBack(node);
+    // order of the nodes doesn't matter to the garbage collector, so new nodes go to the front instead of walking the whole list
+    m_root.insert(node);
+    return node;
+}
+
+StringNode *State::createString(std::string &&base)
+{
+    StringNode *node = new StringNode(std::move(base));
+    m_root.insert(node);
     return node;
 }
 
 ArrayNode *State::createArray(std::vector<Value> const values)
 {
     ArrayNode *node = new ArrayNode(values);
-    m_root.pushBack(node);
+    m_root.insert(node);
+    return node;
+}
+
+SequenceNode *State::createSequence(ArrayNode *array)
+{
+    SequenceNode *node = new SequenceNode(array);
+    m_root.insert(node);
+    return node;
+}
+
+SequenceNode *State::createSequence(SequenceSourceType type, std::string const &path)
+{
+    SequenceNode *node = new SequenceNode(type, path);
+    m_root.insert(node);
+    return node;
+}
+
+SequenceNode *State::createSequence(SequenceNode const &base, SequenceStage const &stage)
+{
+    SequenceNode *node = new SequenceNode(base, stage);
+    m_root.insert(node);
     return node;
 }
 
@@ -89,6 +171,9 @@ void State::pushVariableScope(std::map<std::string, Value> variables)
         case ValueType::Array:
             std::get<ArrayNode *>(v.second)->increaseRefCount();
             break;
+        case ValueType::Sequence:
+            std::get<SequenceNode *>(v.second)->increaseRefCount();
+            break;
         }
     }
 }
@@ -109,6 +194,10 @@ void State::popVariableScope()
         {
             std::get<StringNode *>(var.second)->decreaseRefCount();
         }
+        else if (var.second.index() == ValueType::Sequence)
+        {
+            std::get<SequenceNode *>(var.second)->decreaseRefCount();
+        }
     }
     m_variables.pop_back();
     collectGarbage();
@@ -118,6 +207,7 @@ void State::addFunction(std::string const &name, std::vector<std::string> argume
 {
     m_functionNames.push_back(name);
     m_functions.push_back(Function(body, arguments));
+    m_taskTemplate.reset();
 }
 
 std::optional<Function> State::getFunction(std::string const &name) const
@@ -187,7 +277,7 @@ void State::collectGarbage()
     }
 }
 
-State::~State()
+void State::freeAllObjects()
 {
     MemoryNode *prev = &m_root;
     MemoryNode *curr = m_root.getNext();
@@ -202,3 +292,8 @@ State::~State()
         delete del;
     }
 }
+
+State::~State()
+{
+    freeAllObjects();
+}
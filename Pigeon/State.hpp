@@ -2,11 +2,20 @@
 #include "Memory.hpp"
 #include "Value.hpp"
 #include "Array.hpp"
+#include "Sequence.hpp"
 #include <map>
 #include <vector>
 #include <optional>
 #include <functional>
 #include "Function.hpp"
+#include "Process.hpp"
+#include "StatCache.hpp"
+#include "Regex.hpp"
+#include "FileWriter.hpp"
+#include "Isolate.hpp"
+#include <memory>
+
+class Program;
 
 class State
 {
@@ -20,16 +29,59 @@ public:
     /// @param funcs Standard functions to add to the state
     explicit State(std::vector<NativeFunction> const &funcs);
 
+    /// @brief Create a state for an isolate, which has same standard and user functions and channels as the parent, but its own memory and variables.
+    /// Functions of the parent declared after this are not visible in the new state
+    /// @param parent
+    /// @return
+    static std::unique_ptr<State> createIsolatedState(State const &parent);
+
+    /// @brief Create a state for running tasks, which is an isolated state of the template that can be reused for many tasks with `resetForTask`
+    /// @param taskTemplate Template returned by `getTaskTemplate` of the state that spawns the tasks
+    /// @return
+    static std::unique_ptr<State> createTaskState(std::shared_ptr<State const> const &taskTemplate);
+
+    /// @brief Get an isolated state that is never run and only serves as the source of functions for states that run tasks.
+    /// It is created on first use and shared until functions or programs of this state change, so spawning a task doesn't copy the function table
+    /// @return
+    std::shared_ptr<State const> getTaskTemplate();
+
+    /// @brief Prepare a state created by `createTaskState` for the next task by stopping the tasks it spawned, removing all variables and freeing all objects
+    /// @return False if the state can't be reused, because the task declared functions or left background commands, coprocesses, files or isolates open,
+    /// which are only cleaned up by destroying the state
+    bool resetForTask();
+
     /// @brief  Create a new string object and store it in the state memory
     /// @param base Inital value for the string object
     /// @return Pointer to the string object
     StringNode *createString(std::string const &base);
 
+    /// @brief  Create a new string object that takes ownership of the given string without copying it
+    /// @param base Inital value for the string object
+    /// @return Pointer to the string object
+    StringNode *createString(std::string &&base);
+
     /// @brief Create a new array object and store it in the state memory
     /// @param values Inital contents of the array
     /// @return Pointer to the array object
     ArrayNode *createArray(std::vector<Value> const values);
 
+    /// @brief Create a new lazy sequence that goes over elements of the array and store it in the state memory
+    /// @param array Array that sequence reads
+    /// @return Pointer to the sequence object
+    SequenceNode *createSequence(ArrayNode *array);
+
+    /// @brief Create a new lazy sequence that reads entries of the directory or lines of the file and store it in the state memory
+    /// @param type Either directory or file lines
+    /// @param path Path to the directory or file that sequence reads
+    /// @return Pointer to the sequence object
+    SequenceNode *createSequence(SequenceSourceType type, std::string const &path);
+
+    /// @brief Create a new lazy sequence that extends existing sequence with another stage and store it in the state memory
+    /// @param base Sequence that provides the source and previous stages
+    /// @param stage Stage added after all stages of the base
+    /// @return Pointer to the sequence object
+    SequenceNode *createSequence(SequenceNode const &base, SequenceStage const &stage);
+
     /// @brief Attempt to get the value of a variable in the state
     /// @param name Name of the variable
     /// @return Value of the variable or None if no variable exists
@@ -79,12 +131,74 @@ public:
 
     void collectGarbage();
 
+    /// @brief Remember the program whose functions are declared in this state, which keeps the program alive as long as the state exists.
+    /// State can run several programs, such as every line entered in interactive mode, and all of them are kept
+    /// @param program
+    void addProgram(std::shared_ptr<Program const> program);
+
+    /// @brief Get channels shared by this state and all isolates started by it
+    /// @return
+    Pigeon::ChannelRegistry &getChannels() { return *m_channels; }
+
+    /// @brief Get the object that owns isolates started by this state
+    /// @return
+    Pigeon::IsolateManager &getIsolateManager() { return m_isolates; }
+
+    /// @brief Get the object that remembers tasks spawned by this state until they are joined
+    /// @return
+    Pigeon::TaskManager &getTaskManager() { return m_tasks; }
+
+    /// @brief Get the object that tracks commands started in the background by this state
+    /// @return
+    Pigeon::Process::ProcessManager &getProcessManager() { return m_processManager; }
+
+    /// @brief Get the object that owns helper programs started with `coproc_open` by this state
+    /// @return
+    Pigeon::Process::CoprocessManager &getCoprocessManager() { return m_coprocessManager; }
+
+    /// @brief Get the object that owns files opened for writing with `file_open` by this state
+    /// @return
+    Pigeon::FileWriterManager &getFileWriters() { return m_fileWriters; }
+
+    /// @brief Get the cache of program locations used for running commands in this state
+    /// @return
+    Pigeon::Process::CommandPathCache &getCommandPathCache() { return m_commandPathCache; }
+
+    /// @brief Get totals of resource usage of all commands run by this state, grouped by program name
+    /// @return
+    Pigeon::Process::CommandStatistics &getCommandStatistics() { return m_commandStatistics; }
+
+    /// @brief Get the cache of file metadata used by file predicates of this state
+    /// @return
+    Pigeon::StatCache &getStatCache() { return m_statCache; }
+
+    /// @brief Get the cache of regular expressions compiled by this state
+    /// @return
+    Pigeon::RegexCache &getRegexCache() { return m_regexCache; }
+
     ~State();
 
 private:
+    /// @brief Free every object in the memory, whether it's still referenced or not
+    void freeAllObjects();
+
     std::vector<NativeFunction> m_standardFunctions;
     std::vector<std::map<std::string, Value>> m_variables;
     MemoryNode m_root;
     std::vector<std::string> m_functionNames;
     std::vector<Function> m_functions;
+    Pigeon::Process::CommandPathCache m_commandPathCache;
+    Pigeon::Process::CommandStatistics m_commandStatistics;
+    Pigeon::StatCache m_statCache;
+    Pigeon::RegexCache m_regexCache;
+    Pigeon::Process::ProcessManager m_processManager;
+    Pigeon::Process::CoprocessManager m_coprocessManager;
+    Pigeon::FileWriterManager m_fileWriters;
+    std::vector<std::shared_ptr<Program const>> m_programs;
+    std::shared_ptr<Pigeon::ChannelRegistry> m_channels = std::make_shared<Pigeon::ChannelRegistry>();
+    /// @brief Template with the current functions of this state, or null if it wasn't needed since they last changed
+    std::shared_ptr<State const> m_taskTemplate;
+    /// @brief Last so that isolates are joined before anything else of the state is destroyed
+    Pigeon::TaskManager m_tasks;
+    Pigeon::IsolateManager m_isolates;
 };
\ No newline at end of file
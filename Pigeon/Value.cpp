@@ -1,6 +1,7 @@
 #include "Value.hpp"
 #include "Memory.hpp"
 #include "Array.hpp"
+#include "Sequence.hpp"
 std::string convertValueToString(Value const &val)
 {
     switch (val.index())
@@ -8,7 +9,7 @@ std::string convertValueToString(Value const &val)
     case ValueType::Integer:
         return std::to_string(std::get<int64_t>(val));
     case ValueType::String:
-        return std::get<StringNode *>(val)->getValue();
+        return std::string(std::get<StringNode *>(val)->getView());
     case ValueType::Array:
         return std::get<ArrayNode *>(val)->toString();
     case ValueType::FunctionRef:
@@ -16,6 +17,8 @@ std::string convertValueToString(Value const &val)
                std::to_string(std::get<FunctionRef>(val).id) +
                " is-native = " +
                (std::get<FunctionRef>(val).native ? "true" : "false") + " }";
+    case ValueType::Sequence:
+        return "Sequence";
     default:
         throw RuntimeActionExecutionError("Rest of value handling not implemented. Type with index " + std::to_string(val.index()) + " is not implemented");
     }
@@ -28,12 +31,14 @@ bool isValueNull(Value const &val)
     case ValueType::Integer:
         return std::get<int64_t>(val) == 0;
     case ValueType::String:
-        return std::get<StringNode *>(val)->getValue() == "";
+        return std::get<StringNode *>(val)->getView().empty();
     case ValueType::Array:
         return std::get<ArrayNode *>(val)->isEmpty();
     case ValueType::FunctionRef:
         // these simply can't be null
         return false;
+    case ValueType::Sequence:
+        return false;
     default:
         throw RuntimeActionExecutionError("Rest of value null handling not implemented");
     }
@@ -49,6 +54,9 @@ void increaseValueRefCount(Value const &val)
     case ValueType::Array:
         std::get<ArrayNode *>(val)->increaseRefCount();
         break;
+    case ValueType::Sequence:
+        std::get<SequenceNode *>(val)->increaseRefCount();
+        break;
     }
 }
 
@@ -62,6 +70,9 @@ void decreaseValueRefCount(Value const &val)
     case ValueType::Array:
         std::get<ArrayNode *>(val)->decreaseRefCount();
         break;
+    case ValueType::Sequence:
+        std::get<SequenceNode *>(val)->decreaseRefCount();
+        break;
     }
 }
 
@@ -83,22 +94,26 @@ bool areValuesTheSame(Value const &a, Value const &b)
     }
     else if (a.index() == ValueType::String && b.index() == ValueType::String)
     {
-        return std::get<StringNode *>(a)->getValue() == std::get<StringNode *>(b)->getValue();
+        return std::get<StringNode *>(a)->getView() == std::get<StringNode *>(b)->getView();
     }
     else if (a.index() == ValueType::Array && b.index() == ValueType::Array)
     {
 
         return std::get<ArrayNode *>(a)->equalTo(std::get<ArrayNode *>(b));
     }
+    else if (a.index() == ValueType::Sequence && b.index() == ValueType::Sequence)
+    {
+        return std::get<SequenceNode *>(a) == std::get<SequenceNode *>(b);
+    }
 
     else if (a.index() == ValueType::Integer && b.index() == ValueType::String)
     {
-        return std::to_string(std::get<int64_t>(a)) == std::get<StringNode *>(b)->getValue();
+        return std::to_string(std::get<int64_t>(a)) == std::get<StringNode *>(b)->getView();
     }
 
     else if (a.index() == ValueType::String && b.index() == ValueType::Integer)
     {
-        return std::get<StringNode *>(a)->getValue() == std::to_string(std::get<int64_t>(b));
+        return std::get<StringNode *>(a)->getView() == std::to_string(std::get<int64_t>(b));
     }
 
     return false;
@@ -120,6 +135,8 @@ bool areValuesEqual(Value const &a, Value const &b)
         return std::get<ArrayNode *>(a) == std::get<ArrayNode *>(b);
     case ValueType::FunctionRef:
         return std::get<FunctionRef>(a).id == std::get<FunctionRef>(b).id && std::get<FunctionRef>(a).native == std::get<FunctionRef>(b).native;
+    case ValueType::Sequence:
+        return std::get<SequenceNode *>(a) == std::get<SequenceNode *>(b);
     }
     // should not be reachable but exists in case of future changes
     return false;
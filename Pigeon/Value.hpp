@@ -7,6 +7,7 @@
 #include <cstdint>
 class StringNode;
 class ArrayNode;
+class SequenceNode;
 
 using IntegerType = int64_t;
 struct FunctionReference
@@ -15,14 +16,15 @@ struct FunctionReference
     bool native;
 };
 
-using Value = std::variant<IntegerType, StringNode *, ArrayNode *, FunctionReference>;
+using Value = std::variant<IntegerType, StringNode *, ArrayNode *, FunctionReference, SequenceNode *>;
 
 enum ValueType
 {
     Integer = 0,
     String = 1,
     Array = 2,
-    FunctionRef = 3
+    FunctionRef = 3,
+    Sequence = 4
 };
 
 /// @brief Get provided value as integer. This does not perform type conversions
@@ -33,6 +35,8 @@ inline StringNode *getValueAsString(Value const &v) { return std::get<StringNode
 inline ArrayNode *getValueAsArray(Value const &v) { return std::get<ArrayNode *>(v); }
 /// @brief Get provided value as reference to native or user function. This does not perform type conversions
 inline FunctionReference getValueAsFunction(Value const &v) { return std::get<FunctionReference>(v); }
+/// @brief Get provided value as pointer to the SequenceNode that describes a lazy sequence. This does not perform type conversions
+inline SequenceNode *getValueAsSequence(Value const &v) { return std::get<SequenceNode *>(v); }
 
 std::string convertValueToString(Value const &val);
 
@@ -46,6 +50,8 @@ std::string convertValueToString(Value const &val);
  *  - Array: Array must be empty
  * 
  *  - FunctionReference: Because of how it functions it simply can never be null
+ *
+ *  - Sequence: Never null, since finding out if it has any elements requires running it
  * 
  * @param val 
  * @return true 
@@ -78,6 +84,8 @@ void decreaseValueRefCount(Value const &val);
  * 
  * - Function to function comparison -> Must point to the same function. This also means that equality check has same effect
  *
+ * - Sequence to sequence comparison -> Must be the same sequence, contents are not compared since that would require running both
+ *
  * @param a
  * @param b
  * @return true
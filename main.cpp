@@ -10,6 +10,7 @@
 
 #include "Pigeon/State.hpp"
 #include "Pigeon/Parser.hpp"
+#include "Pigeon/Program.hpp"
 
 #include "GobScriptHelper/StandardFunctions.hpp"
 #include "GobScriptHelper/Interactive.hpp"
@@ -23,7 +24,10 @@
 
 
 
-int runFileMode(std::string const &filepath)
+/// @brief Run code from the file
+/// @param filepath Path to the file
+/// @param profileCommands If true totals of time and memory used by every program started by the script are printed to stderr once the script ends
+int runFileMode(std::string const &filepath, bool profileCommands)
 {
     using namespace GobScriptHelper;
     if (!std::filesystem::exists(filepath))
@@ -33,22 +37,29 @@ int runFileMode(std::string const &filepath)
     }
     std::ifstream codeFile(filepath);
 
-    std::string program = std::string{std::istreambuf_iterator<char>(codeFile), std::istreambuf_iterator<char>()};
+    // program outlives the state, since isolates started by the state run its functions until the state is destroyed
+    std::shared_ptr<Program> program = std::make_shared<Program>(std::string{std::istreambuf_iterator<char>(codeFile), std::istreambuf_iterator<char>()});
 
     try
     {
+        program->parse();
         State state = prepareScriptState();
-        loadString(program)->execute(state);
+        program->execute(state);
+        if (profileCommands && !state.getCommandStatistics().isEmpty())
+        {
+            std::cout.flush();
+            state.getCommandStatistics().printReport(std::cerr);
+        }
     }
     catch (ParsingError e)
     {
-        displayError(e.getIterator() - program.begin(), program, e.what());
+        displayError(e.getIterator() - program->getCode().begin(), program->getCode(), e.what());
         // std::cerr << "Code error at symbol " << (e.getIterator() - program.begin()) << " :" << e.what() << std::endl;
         return EXIT_FAILURE;
     }
     catch (RuntimeError e)
     {
-        displayError(e.getIterator() - program.begin(), program, e.what());
+        displayError(e.getIterator() - program->getCode().begin(), program->getCode(), e.what());
         // std::cerr << "Code error at symbol " << (e.getIterator() - program.begin()) << " :" << e.what() << std::endl;
         return EXIT_FAILURE;
     }
@@ -67,6 +78,7 @@ int main(int argc, char **argv)
     std::vector<std::string> VersionArgs = {"-v", "--version"};
     std::vector<std::string> HelpArgs = {"-h", "--help"};
     std::vector<std::string> FileArgs = {"-i", "--input"};
+    std::vector<std::string> ProfileArgs = {"-p", "--profile"};
 
     std::vector<std::string>::iterator verIt = std::find_first_of(args.begin(), args.end(), VersionArgs.begin(), VersionArgs.end());
     if (verIt != args.end())
@@ -80,11 +92,12 @@ int main(int argc, char **argv)
     {
         std::cout << "Goblin Script Helper v" << APP_VERSION_MAJOR << "." << APP_VERSION_MINOR << "." << APP_VERSION_PATCH << std::endl;
         std::cout << "A simple scripting tool meant to automate tasks using LISP inspired syntax" << std::endl;
-        std::cout << "Usage: gsh [-i file | -h | -v]" << std::endl;
+        std::cout << "Usage: gsh [-i file [-p] | -h | -v]" << std::endl;
         std::cout << "Options" << std::endl;
         std::cout << "-v | --version    : Display version of the interpreter" << std::endl;
         std::cout << "-h | --help       : View help about the interpreter" << std::endl;
         std::cout << "-i | --input      : Run code from file in a given location" << std::endl;
+        std::cout << "-p | --profile    : Print time and memory used by every program the script has run once the script ends" << std::endl;
         return EXIT_SUCCESS;
     }
 
@@ -96,7 +109,8 @@ int main(int argc, char **argv)
             std::cerr << "Missing file path after file flag" << std::endl;
             return EXIT_FAILURE;
         }
-        return runFileMode(*(verIt + 1));
+        bool profileCommands = std::find_first_of(args.begin(), args.end(), ProfileArgs.begin(), ProfileArgs.end()) != args.end();
+        return runFileMode(*(verIt + 1), profileCommands);
     }
 
     return GobScriptHelper::Interactive::runInteractiveMode();